@@ -25,6 +25,8 @@
 #include <natus/graphics/variable/variable_set.hpp>
 #include <natus/profile/macros.h>
 
+#include <natus/concurrent/global.h>
+
 #include <natus/collide/2d/bounds/aabb.hpp>
 
 #include <natus/math/vector/vector3.hpp>
@@ -33,13 +35,36 @@
 #include <natus/math/utility/angle.hpp>
 #include <natus/math/utility/3d/transformation.hpp>
 
+#include <common/audio_queue.hpp>
+#include <common/fixed_step.hpp>
+#include <common/code_points.hpp>
+#include <common/parallel_for.hpp>
+#include <common/tick_graph.hpp>
+#include <common/input_queue.hpp>
+#include <common/startup_trace.hpp>
+#include <common/triple_buffer.hpp>
+#include <common/sheet_reload.hpp>
+
 #include <thread>
+#include <filesystem>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <fstream>
+#include <cstring>
 
 namespace space_intruders
 {
     static size_t const NUM_LAYERS = 100 ;
 
+    // all text drawn besides the score
+    static char const * const TITLE = "space intruders" ;
+
     using namespace natus::core::types ;
+    using namespace games ;
 
     //
     //
@@ -76,6 +101,9 @@ namespace space_intruders
 
             natus::math::vec2f_t pos ;
 
+            // the position before the last physics step
+            natus::math::vec2f_t prev_pos ;
+
             size_t obj_id = size_t( -1 ) ;
             size_t ani_id = size_t( -1 ) ;
             size_t anim_time = 0 ;
@@ -105,6 +133,41 @@ namespace space_intruders
                 return natus::collide::n2d::aabbf_t( p0, p2 ) ;
             }
 
+            // re-resolves the ids by object and animation name after the
+            // sprite sheet was re-baked. Falls back to 0 if a name is gone.
+            void_t remap( natus::gfx::sprite_sheet_cref_t from, natus::gfx::sprite_sheet_cref_t to ) noexcept
+            {
+                if( obj_id >= from.objects.size() ) return ;
+                auto const & fo = from.objects[obj_id] ;
+
+                auto const oiter = std::find_if( to.objects.begin(), to.objects.end(), 
+                    [&]( natus::gfx::sprite_sheet::object const & o )
+                {
+                    return o.name == fo.name ;
+                } ) ;
+                obj_id = oiter == to.objects.end() ? 0 : std::distance( to.objects.begin(), oiter ) ;
+                if( obj_id >= to.objects.size() ) return ;
+
+                auto const & to_ = to.objects[obj_id] ;
+
+                size_t new_ani = 0 ;
+                if( ani_id < fo.animations.size() )
+                {
+                    auto const aiter = std::find_if( to_.animations.begin(), to_.animations.end(), 
+                        [&]( natus::gfx::sprite_sheet::animation const & a )
+                    {
+                        return a.name == fo.animations[ani_id].name ;
+                    } ) ;
+                    if( aiter != to_.animations.end() ) new_ani = std::distance( to_.animations.begin(), aiter ) ;
+                }
+                ani_id = new_ani ;
+                if( ani_id >= to_.animations.size() ) return ;
+
+                size_t const d = to_.animations[ani_id].duration ;
+                max_ani_time = d == 0 ? 1 : d ;
+                anim_time = anim_time % max_ani_time ;
+            }
+
             static natus::ntd::vector< this_t > load_from( natus::gfx::sprite_sheet_cref_t sheet, 
                 natus::ntd::vector< natus::ntd::string_t > names,
                 natus::ntd::vector< natus::ntd::string_t > animations ) noexcept
@@ -159,6 +222,10 @@ namespace space_intruders
         size_t _intruders_w = 10 ;
         size_t _intruders_h = 6 ;
 
+        // per entity loops are split into chunks of at least that many 
+        // entities. Smaller waves run serially.
+        size_t _grain = 1024 ;
+
         natus::ntd::vector< intruder_t > _intruders ;
         natus::math::vec2f_t _intruders_offset = natus::math::vec2f_t(0.0f, 0.0f) ;
         natus::math::vec2f_t _intruders_speed = natus::math::vec2f_t( 100.0f, 100.0f ) ;
@@ -246,6 +313,32 @@ namespace space_intruders
     private: // graphics
 
         size_t _anim = 0 ;
+
+        struct sprite_item
+        {
+            natus::math::vec2f_t prev_pos ;
+            natus::math::vec2f_t pos ;
+            natus::math::vec2f_t scale ;
+            natus::math::vec4f_t rect ;
+            natus::math::vec2f_t pivot ;
+            natus::math::vec4f_t color ;
+        };
+        natus_typedef( sprite_item ) ;
+
+        // all graphics needs of one physics tick. Graphics only reads this
+        // so it never touches the simulation state.
+        struct render_snapshot
+        {
+            natus::ntd::vector< sprite_item_t > sprites ;
+            natus::ntd::vector< bounding_box_2d_t > boxes ;
+            size_t score = 0 ;
+        };
+        natus_typedef( render_snapshot ) ;
+
+        triple_buffer< render_snapshot_t > _snapshots ;
+
+        // the snapshot drawn this frame. only used by the graphics callbacks.
+        render_snapshot_t const * _drawn = nullptr ;
         
     private: // audio
 
@@ -254,13 +347,28 @@ namespace space_intruders
         natus::audio::buffer_object_res_t _explosion_sound = natus::audio::buffer_object_t() ;
         natus::audio::buffer_object_res_t _hit_player_sound = natus::audio::buffer_object_t() ;
         
-        struct audio_queue_item
-        {
-            natus::audio::buffer_object_res_t buffer ;
-            natus::audio::execution_options eo ;
-            bool_t loop = false ;
-        } ;
-        natus::ntd::vector< audio_queue_item > _audio_play_queue ;
+        // sound ids in the audio queue
+        uint16_t _laser_sid = 0 ;
+        uint16_t _ufo_sid = 0 ;
+        uint16_t _explosion_sid = 0 ;
+        uint16_t _hit_player_sid = 0 ;
+
+        audio_queue_t _audio_queue ;
+
+    private: // input
+
+        // pushed by on_device, applied at the start of a physics step
+        enum class input { move, shoot } ;
+        typedef input_queue< input > inputs_t ;
+        inputs_t _input ;
+
+        // the last movement pushed. only used by on_device.
+        natus::math::vec2f_t _input_move ;
+
+        // pushed by logic, applied at the start of a physics step
+        enum class command { sheets, intruder_shoot } ;
+        typedef input_queue< command > commands_t ;
+        commands_t _commands { "command" } ;
 
     private: // score
 
@@ -270,18 +378,49 @@ namespace space_intruders
 
         size_t get_score( void_t ) const noexcept { return _score ; }
 
+        // the score of the snapshot drawn this frame
+        size_t get_drawn_score( void_t ) const noexcept { return _drawn != nullptr ? _drawn->score : 0 ; }
+
     public:
 
         struct init_data
         {
-            natus::gfx::sprite_sheets_res_t sheets ;
+            // published anew on every hot reload
+            sheet_reload_t::current_sheets_ptr_t sheets ;
             natus::audio::buffer_object_res_t laser ;
             natus::audio::buffer_object_res_t ufo ;
             natus::audio::buffer_object_res_t explosion ;
             natus::audio::buffer_object_res_t hit_player ;
+
+            // the wave size
+            size_t intruders_w = 10 ;
+            size_t intruders_h = 6 ;
+
+            // logs the parallel speedup of the intruder loops after init
+            bool_t report_speedup = false ;
         };
         natus_typedef( init_data ) ;
 
+    private: // tick
+
+        // built on the first tick and reused. The inputs of the current tick
+        // are handed to the nodes through the members below.
+        tick_graph_t _physics_graph ;
+
+        // the published sheets and the ones the ids of the entities refer
+        // to. The latter are only replaced by the physics step.
+        sheet_reload_t::current_sheets_ptr_t _current_sheets ;
+        sheet_reload_t::sheets_ptr_t _sheets ;
+
+        // the animations advance in whole milliseconds of physics time
+        size_t _anim_us = 0 ;
+        size_t _tick_milli_dt = 0 ;
+
+        float_t _tick_dt = 0.0f ;
+        bool_t _tick_march = false ;
+        natus::math::vec2f_t _tick_step ;
+        std::atomic< bool_t > _tick_turn { false } ;
+
     public: // ctors
 
         field( void_t ) noexcept
@@ -333,14 +472,27 @@ namespace space_intruders
 
         bool_t on_init( init_data_rref_t d ) noexcept
         {
-            auto const & sheets = *d.sheets ;
-            if( sheets.size() == 0 ) return false ;
+            _current_sheets = d.sheets ;
+            _sheets = _current_sheets->load() ;
+            if( _sheets == nullptr || _sheets->size() == 0 ) return false ;
+
+            auto const & sheets = *_sheets ;
 
             {
                 _laser_sound = d.laser ;
                 _ufo_sound = d.ufo ;
                 _explosion_sound = d.explosion ;
                 _hit_player_sound = d.hit_player ;
+
+                // max voices, priority, duration
+                _laser_sid = _audio_queue.add_buffer( _laser_sound, 
+                    { 3, 0, std::chrono::milliseconds( 200 ) } ) ;
+                _ufo_sid = _audio_queue.add_buffer( _ufo_sound, 
+                    { 1, 1, std::chrono::milliseconds( 0 ) } ) ;
+                _explosion_sid = _audio_queue.add_buffer( _explosion_sound, 
+                    { 2, 2, std::chrono::milliseconds( 600 ) } ) ;
+                _hit_player_sid = _audio_queue.add_buffer( _hit_player_sound, 
+                    { 1, 3, std::chrono::milliseconds( 500 ) } ) ;
             }
 
             auto const & sheet = sheets[0] ;
@@ -352,14 +504,26 @@ namespace space_intruders
                 
                 natus::ntd::vector< natus::ntd::string_t > animations = { "move" } ;
 
+                _intruders_w = d.intruders_w ;
+                _intruders_h = d.intruders_h ;
+
+                // one intruder kind per row
                 auto const intrs = intruder_t::load_from( sheet, names, animations ) ;
-                for( auto const & intr : intrs )
-                    for( size_t i=0; i<_intruders_w; ++i )
-                        _intruders.emplace_back( intr ) ;
+                if( intrs.size() > 0 )
+                {
+                    _intruders.reserve( _intruders_w * _intruders_h ) ;
+                    for( size_t y=0; y<_intruders_h; ++y )
+                        for( size_t x=0; x<_intruders_w; ++x )
+                            _intruders.emplace_back( intrs[ y % intrs.size() ] ) ;
+                }
 
-                // init positions
+                // init positions. big waves are packed into the same area.
                 {
                     auto const start = natus::math::vec2f_t( -350.0f, 200.0f ) ;
+                    auto const spacing = natus::math::vec2f_t( 
+                        std::min( 800.0f/20.0f, 400.0f / float_t( _intruders_w ) ),
+                        std::min( 600.0f/10.0f, 360.0f / float_t( _intruders_h ) ) ) ;
+
                     for( size_t i=0; i<_intruders.size(); ++i )
                     {
                         size_t const y = i / _intruders_w ;
@@ -367,8 +531,8 @@ namespace space_intruders
 
                         auto & intr = _intruders[i] ;
                         intr.pos = start + natus::math::vec2f_t( 
-                            float_t(x) * (800.0f/20.0f), 
-                            -float_t(y) * (600.0f/10.0f) ) ;
+                            float_t(x) * spacing.x(), 
+                            -float_t(y) * spacing.y() ) ;
                     }
                 }
             }
@@ -438,9 +602,80 @@ namespace space_intruders
                 _ufo_physics_tp = clock_t::now() ;
                 _intruders_shoot_tp = clock_t::now() ;
             }
+
+            if( d.report_speedup ) this_t::report_speedup( sheets ) ;
+
             return true ;
         }
 
+        // runs the intruder loops with 1, 2, 4 ... tasks up to the hardware 
+        // threads and logs the time and the speedup against a single task
+        void_t report_speedup( natus::gfx::sprite_sheets_cref_t sheets ) noexcept
+        {
+            size_t const reps = 20 ;
+            size_t const hw = std::max( size_t( std::thread::hardware_concurrency() ), size_t( 1 ) ) ;
+
+            size_t base_us = 0 ;
+            for( size_t tasks=1; ; tasks = std::min( tasks * 2, hw ) )
+            {
+                auto const tp = clock_t::now() ;
+                for( size_t r=0; r<reps; ++r )
+                {
+                    parallel_for( _intruders.size(), _grain, [&]( size_t const b, size_t const e )
+                    {
+                        this_t::animate_intruders( sheets, 16, b, e ) ;
+                        this_t::march_intruders( natus::math::vec2f_t( 0.0f ), b, e ) ;
+                    }, tasks ) ;
+                }
+                size_t const us = size_t( std::chrono::duration_cast< std::chrono::microseconds >( 
+                    clock_t::now() - tp ).count() ) / reps ;
+
+                if( tasks == 1 ) base_us = us ;
+
+                natus::log::global_t::status( "[parallel_for] : " + std::to_string( _intruders.size() ) + 
+                    " intruders, " + std::to_string( tasks ) + " tasks : " + std::to_string( us ) + " us, speedup " + 
+                    std::to_string( float_t( base_us ) / float_t( std::max( us, size_t( 1 ) ) ) ) ) ;
+
+                if( tasks == hw ) break ;
+            }
+        }
+
+        // advances the animation of the intruders in [b,e)
+        void_t animate_intruders( natus::gfx::sprite_sheets_cref_t sheets, size_t const milli_dt, 
+            size_t const b, size_t const e ) noexcept
+        {
+            size_t const sheet = 0 ;
+
+            for( size_t i=b; i<e; ++i )
+            {
+                auto & intr = _intruders[ i ] ;
+
+                intr.cur_sprite = sheets[sheet].determine_sprite( intr.obj_id, intr.ani_id, intr.anim_time ) ;
+                intr.anim_time += milli_dt ;
+                intr.anim_time = intr.anim_time % intr.max_ani_time ;
+            }
+        }
+
+        // moves the intruders in [b,e) by step. Returns true if any of them
+        // is outside the march bounds afterwards.
+        bool_t march_intruders( natus::math::vec2f_t const step, size_t const b, size_t const e ) noexcept
+        {
+            bool_t out = false ;
+            for( size_t i=b; i<e; ++i )
+            {
+                auto & intr = _intruders[ i ] ;
+
+                intr.pos += step ;
+
+                // a march is a jump, so it is not interpolated
+                intr.prev_pos = intr.pos ;
+
+                out = out || (intr.pos.x() > (400.0f - (800.0f/10.0f))) ||
+                    (intr.pos.x() < (-400.0f + (800.0f/10.0f))) ;
+            }
+            return out ;
+        }
+
         void_t on_update( void_t ) noexcept
         {
             //auto const dt = std::chrono::milliseconds( milli_dt ) ;
@@ -451,167 +686,221 @@ namespace space_intruders
             using ctrl_t = natus::device::layouts::game_controller_t ;
             ctrl_t ctrl( dev ) ;
 
+            // only changes are pushed
+            auto const move = [&]( natus::math::vec2f_t const & v )
+            {
+                if( v.x() == _input_move.x() && v.y() == _input_move.y() ) return ;
+                if( _input.push( input::move, v ) ) _input_move = v ;
+            } ;
+
             natus::math::vec2f_t value ;
             if( ctrl.is( ctrl_t::directional::movement, natus::device::components::stick_state::tilting, value ) )
             {
-                _player.comp.adv = value ;
+                move( value ) ;
             }
             if( ctrl.is( ctrl_t::directional::movement, natus::device::components::stick_state::untilted, value ) )
             {
-                _player.comp.adv = natus::math::vec2f_t() ;
+                move( natus::math::vec2f_t() ) ;
             }
 
             {
                 float_t bnt_value = 0.0f ;
                 if( ctrl.is( ctrl_t::button::shoot, natus::device::components::button_state::pressed, bnt_value ) )
+                {
+                    _input.push( input::shoot ) ;
+                }
+            }
+        }
+
+        // applies the input pushed since the last physics step
+        void_t apply_input( void_t ) noexcept
+        {
+            _input.consume( [&]( inputs_t::event_cref_t e )
+            {
+                switch( e.what )
+                {
+                case input::move: 
+                    _player.comp.adv = e.value ;
+                    break ;
+
+                case input::shoot:
                 {
                     auto s = _projectiles[0] ;
                     s.comp.adv = natus::math::vec2f_t( 0.0f, 1.0f ) ;
                     s.pos = _player.pos ;
+                    s.prev_pos = s.pos ;
                     s.comp.from = 1 ;
                     _shots.emplace_back( s ) ;
 
-                    {
-                        audio_queue_item item ;
-                        item.buffer = _laser_sound ;
-                        item.eo = natus::audio::execution_options::play ;
-                        _audio_play_queue.emplace_back( item ) ;
-                    }
+                    _audio_queue.push( audio_queue_t::producer::physics, _laser_sid, natus::audio::execution_options::play ) ;
+                    break ;
                 }
-            }
+                }
+            } ) ;
         }
 
-        void_t on_logic( natus::gfx::sprite_sheets_cref_t sheets, size_t const milli_dt ) noexcept 
+        // applies the commands pushed since the last physics step
+        void_t apply_commands( void_t ) noexcept
         {
-            this_t::reset() ;
-
-            size_t const sheet = 0 ;
-
-            // projectiles
+            _commands.consume( [&]( commands_t::event_cref_t e )
             {
-                for( auto & shot : _shots )
+                switch( e.what )
                 {
-                    shot.cur_sprite = sheets[sheet].determine_sprite( shot.obj_id, shot.ani_id, shot.anim_time ) ;
-                    shot.anim_time += milli_dt ;
-                    shot.anim_time = shot.anim_time % shot.max_ani_time ;
+                case command::sheets: 
+                    this_t::take_over_sheets() ;
+                    break ;
+
+                case command::intruder_shoot:
+                    this_t::fire_intruder_shot() ;
+                    break ;
                 }
-            }
+            } ) ;
+        }
 
-            // intruders
-            {
-                for( size_t y=0; y<_intruders_h; ++y )
-                {
-                    for( size_t x=0; x<_intruders_w; ++x )
-                    {
-                        size_t const idx = y * _intruders_w + x ;
-                        auto & intr = _intruders[ idx ] ;
+        // called by logic after the sprite sheets were hot reloaded. The ids
+        // are remapped at the start of the next physics step.
+        void_t on_sprite_sheets_changed( void_t ) noexcept
+        {
+            if( _commands.push( command::sheets ) ) return ;
+            natus::log::global_t::warning( "[hot reload] : command queue full. sheets not taken over" ) ;
+        }
 
-                        intr.cur_sprite = sheets[sheet].determine_sprite( intr.obj_id, intr.ani_id, intr.anim_time ) ;
-                        intr.anim_time += milli_dt ;
-                        intr.anim_time = intr.anim_time % intr.max_ani_time ;
-                    }
-                }
-            }
+        // remaps the ids from the sheets physics played with to the newest
+        // published sheets. Reloads published in between are taken at once.
+        void_t take_over_sheets( void_t ) noexcept
+        {
+            auto to_ptr = _current_sheets->load() ;
+            if( to_ptr == nullptr || to_ptr == _sheets ) return ;
 
-            // ufo
-            if( _ufo.ani_id != size_t(-1) )
-            {
-                _ufo.cur_sprite = sheets[sheet].determine_sprite( _ufo.obj_id, _ufo.ani_id, _ufo.anim_time ) ;
-                _ufo.anim_time += milli_dt ;
-                _ufo.anim_time = _ufo.anim_time % _ufo.max_ani_time ;
-            }
+            auto const from_ptr = std::move( _sheets ) ;
+            _sheets = to_ptr ;
 
-            // player
-            if( _player.ani_id != size_t(-1) )
-            {
-                _player.cur_sprite = sheets[sheet].determine_sprite( _player.obj_id, _player.ani_id, _player.anim_time ) ;
-                _player.anim_time += milli_dt ;
-                _player.anim_time = _player.anim_time % _player.max_ani_time ;
-            }
+            size_t const sheet = 0 ;
+            if( from_ptr == nullptr || from_ptr->size() <= sheet || to_ptr->size() <= sheet ) return ;
 
-            // defense
-            for( auto & d : _defenses )
+            auto const & from = *from_ptr ;
+            auto const & to = *to_ptr ;
+
+            for( auto & e : _intruders ) e.remap( from[sheet], to[sheet] ) ;
+            for( auto & e : _projectiles ) e.remap( from[sheet], to[sheet] ) ;
+            for( auto & e : _shots ) e.remap( from[sheet], to[sheet] ) ;
+            for( auto & e : _defenses ) e.remap( from[sheet], to[sheet] ) ;
+
+            _ufo.remap( from[sheet], to[sheet] ) ;
+            _player.remap( from[sheet], to[sheet] ) ;
+        }
+
+        // the entities are animated and shots are fired by physics
+        void_t on_logic( size_t const milli_dt ) noexcept 
+        {
+            // test intruder shoot time
+            if( (clock_t::now() - _intruders_shoot_tp) > _intruders_shoot_dur )
             {
-                d.cur_sprite = sheets[sheet].determine_sprite( d.obj_id, d.ani_id, 0 ) ;
+                _intruders_shoot_tp = clock_t::now() ;
+                _commands.push( command::intruder_shoot ) ;
             }
 
-            // test intruder shoot time
+            _anim += milli_dt ;
+            _anim = _anim > 5000 ? 0 : _anim ;
+        }
+
+        // the next intruder in line that is still alive shoots
+        void_t fire_intruder_shot( void_t ) noexcept
+        {
+            static size_t sx = 0 ;
+
+            for( size_t y = _intruders_h-size_t(1); y > 0; --y )
             {
-                if( (clock_t::now() - _intruders_shoot_tp) > _intruders_shoot_dur )
+                size_t const x = sx++ % _intruders_w ;
+                size_t const idx = y * _intruders_w + x ;
+                
+                if( !_intruders[ idx ].hit )
                 {
-                    static size_t sx = 0 ;
+                    auto s = _projectiles[sx%_projectiles.size()] ;
+                    s.comp.adv = natus::math::vec2f_t( 0.0f, -1.0f ) ;
+                    s.pos = _intruders[ idx ].pos ;
+                    s.prev_pos = s.pos ;
+                    s.comp.from = 2 ;
+                    _shots.emplace_back( s ) ;
 
-                    _intruders_shoot_tp = clock_t::now() ;
-                    for( size_t y = _intruders_h-size_t(1); y > 0; --y )
-                    {
-                        size_t const x = sx++ % _intruders_w ;
-                        size_t const idx = y * _intruders_w + x ;
-                        
-                        if( !_intruders[ idx ].hit )
-                        {
-                            auto s = _projectiles[sx%_projectiles.size()] ;
-                            s.comp.adv = natus::math::vec2f_t( 0.0f, -1.0f ) ;
-                            s.pos = _intruders[ idx ].pos ;
-                            s.comp.from = 2 ;
-                            _shots.emplace_back( s ) ;
-
-
-                            {
-                                audio_queue_item item ;
-                                item.buffer = _laser_sound ;
-                                item.eo = natus::audio::execution_options::play ;
-                                _audio_play_queue.emplace_back( item ) ;
-                            }
+                    _audio_queue.push( audio_queue_t::producer::physics, _laser_sid, natus::audio::execution_options::play ) ;
 
-                            break ;
-                        }
-                    }
+                    break ;
                 }
             }
+        }
 
-            _anim += milli_dt ;
-            _anim = _anim > 5000 ? 0 : _anim ;
+        // one fixed physics step
+        void_t on_physics( size_t const micro_dt ) noexcept
+        {
+            if( _sheets == nullptr || _sheets->size() == 0 ) return ;
+
+            _tick_dt = (float_t(micro_dt) / 1000000.0f) ;
+
+            _anim_us += micro_dt ;
+            _tick_milli_dt = _anim_us / 1000 ;
+            _anim_us -= _tick_milli_dt * 1000 ;
+
+            this_t::reset() ;
+            this_t::apply_commands() ;
+            this_t::apply_input() ;
+
+            // intruders
+            _tick_march = (clock_t::now() - _intruders_physics_tp) > _intruders_physics_dur ;
+            if( _tick_march ) _intruders_physics_tp = clock_t::now() ;
+
+            _tick_step = _tick_march ? 
+                _intruders_dir * natus::math::vec2f_t( 800.0f/20.0f, 0.0f ) : natus::math::vec2f_t( 0.0f ) ;
+
+            _tick_turn = false ;
+
+            if( _physics_graph.empty() ) this_t::build_physics_graph() ;
+            _physics_graph.run() ;
+
+            if( _tick_turn ) _intruders_dir *= natus::math::vec2f_t( -1.0f, 1.0f ) ;
+
+            this_t::publish_snapshot() ;
         }
 
-        void_t on_physics( size_t const milli_dt ) noexcept
+        // the movers are independent nodes, collision runs when all of them
+        // are done. Every node sets the previous positions of what it moves 
+        // for the interpolation and animates it.
+        void_t build_physics_graph( void_t ) noexcept
         {
-            float_t const dt = (float_t(milli_dt) / 1000.0f) ;
+            size_t const sheet = 0 ;
 
-            if( (clock_t::now() - _intruders_physics_tp) > _intruders_physics_dur )
+            auto & g = _physics_graph ;
+
+            // intruders
+            auto const intruders = g.add_for( [this]( void_t ){ return _intruders.size() ; }, _grain, 
+                [this]( size_t const b, size_t const e )
             {
-                _intruders_physics_tp = clock_t::now() ;
+                this_t::animate_intruders( *_sheets, _tick_milli_dt, b, e ) ;
+                if( this_t::march_intruders( _tick_step, b, e ) && _tick_march ) _tick_turn = true ;
+            } ) ;
 
-                for( auto & intr : _intruders ) 
-                {
-                    intr.pos +=_intruders_dir * natus::math::vec2f_t( 800.0f/20.0f, 0.0f ) ;
-                }
+            // ufo
+            auto const ufo = g.add( [this, sheet]( void_t )
+            {
+                float_t const dt = _tick_dt ;
 
-                for( auto & intr : _intruders ) 
+                if( _ufo.ani_id != size_t(-1) )
                 {
-                    if( (intr.pos.x() > (400.0f - (800.0f/10.0f))) ||
-                        (intr.pos.x() < (-400.0f + (800.0f/10.0f))) )
-                    {
-                        _intruders_dir *= natus::math::vec2f_t( -1.0f, 1.0f ) ;
-                        break ;
-                    }
+                    _ufo.cur_sprite = (*_sheets)[sheet].determine_sprite( _ufo.obj_id, _ufo.ani_id, _ufo.anim_time ) ;
+                    _ufo.anim_time += _tick_milli_dt ;
+                    _ufo.anim_time = _ufo.anim_time % _ufo.max_ani_time ;
                 }
-            }
 
-            // ufo
-            {
+                _ufo.prev_pos = _ufo.pos ;
+
                 if( !_ufo_spawned && (clock_t::now() - _ufo_physics_tp) > _ufo_physics_dur )
                 {
                     _ufo_spawned = true ;
                     if( _ufo_dir.x() < 0.0f ) _ufo.pos = natus::math::vec2f_t( 450.0f, 250.0f ) ; 
                     else _ufo.pos = natus::math::vec2f_t( -450.0f, 250.0f ) ; 
+                    _ufo.prev_pos = _ufo.pos ;
 
-                    {
-                        audio_queue_item item ;
-                        item.buffer = _ufo_sound ;
-                        item.eo = natus::audio::execution_options::play ;
-                        item.loop = true ;
-                        _audio_play_queue.emplace_back( item ) ;
-                    }
+                    _audio_queue.push( audio_queue_t::producer::physics, _ufo_sid, natus::audio::execution_options::play, true ) ;
                 }
             
                 if( _ufo_spawned && _ufo.hit )
@@ -630,18 +919,25 @@ namespace space_intruders
                         _ufo_physics_tp = clock_t::now() ;
                         _ufo_dir *= natus::math::vec2f_t( -1.0f, 1.0f ) ;
 
-                        {
-                            audio_queue_item item ;
-                            item.buffer = _ufo_sound ;
-                            item.eo = natus::audio::execution_options::stop ;
-                            _audio_play_queue.emplace_back( item ) ;
-                        }
+                        _audio_queue.push( audio_queue_t::producer::physics, _ufo_sid, natus::audio::execution_options::stop ) ;
                     }
                 }
-            }
+            } ) ;
 
             // player
+            auto const player = g.add( [this, sheet]( void_t )
             {
+                float_t const dt = _tick_dt ;
+
+                if( _player.ani_id != size_t(-1) )
+                {
+                    _player.cur_sprite = (*_sheets)[sheet].determine_sprite( _player.obj_id, _player.ani_id, _player.anim_time ) ;
+                    _player.anim_time += _tick_milli_dt ;
+                    _player.anim_time = _player.anim_time % _player.max_ani_time ;
+                }
+
+                _player.prev_pos = _player.pos ;
+
                 _player.pos += natus::math::vec2f_t( 300.0f, 0.0f ) * 
                     natus::math::vec2f_t( _player.comp.adv.x() * dt ) ;
 
@@ -650,29 +946,55 @@ namespace space_intruders
                     _player.pos = natus::math::vec2f_t( 390.0f * natus::math::fn<float_t>::sign(_player.pos.x()), 
                         _player.pos.y() ) ;
                 }
-            }
+            } ) ;
 
-            // projectiles
+            // defense
+            auto const defense = g.add( [this, sheet]( void_t )
             {
-                size_t end = _shots.size() ;
-                for( size_t i=0; i<end; ++i )
+                for( auto & d : _defenses )
                 {
-                    if( end == size_t(-1) ) break ;
+                    d.cur_sprite = (*_sheets)[sheet].determine_sprite( d.obj_id, d.ani_id, 0 ) ;
+                }
+            } ) ;
 
+            // projectiles
+            auto const move_shots = g.add_for( [this]( void_t ){ return _shots.size() ; }, _grain, 
+                [this, sheet]( size_t const b, size_t const e )
+            {
+                float_t const dt = _tick_dt ;
+                auto const & s = (*_sheets)[sheet] ;
+
+                for( size_t i=b; i<e; ++i )
+                {
                     auto & proj = _shots[i] ;
 
+                    proj.cur_sprite = s.determine_sprite( proj.obj_id, proj.ani_id, proj.anim_time ) ;
+                    proj.anim_time += _tick_milli_dt ;
+                    proj.anim_time = proj.anim_time % proj.max_ani_time ;
+
+                    proj.prev_pos = proj.pos ;
                     proj.pos += natus::math::vec2f_t( 0.0f, 400.0f ) * 
                         natus::math::vec2f_t( proj.comp.adv ) * natus::math::vec2f_t(dt) ;
+                }
+            } ) ;
 
-                    if( proj.pos.y() > 320.0f || _player.pos.y() < -320.0f )
+            auto const projectiles = g.add( [this]( void_t )
+            {
+                size_t end = _shots.size() ;
+                for( size_t i=0; i<end; ++i )
+                {
+                    auto const & proj = _shots[i] ;
+
+                    if( proj.pos.y() > 320.0f || proj.pos.y() < -320.0f )
                     {
                         _shots[i--] = _shots[--end] ;
                     }
                 }
                 _shots.resize( end ) ;
-            }
+            }, { move_shots } ) ;
 
             // collision testing
+            g.add( [this]( void_t )
             {
                 size_t end = _shots.size() ;
                 for( size_t i=0; i<end; ++i )
@@ -703,20 +1025,8 @@ namespace space_intruders
                             _shots[i--] = _shots[--end] ;
                             _score += 200 ;
 
-                            {
-                                audio_queue_item item ;
-                                item.buffer = _ufo_sound ;
-                                item.eo = natus::audio::execution_options::stop ;
-                                _audio_play_queue.emplace_back( item ) ;
-                            }
-
-                            {
-                                audio_queue_item item ;
-                                item.buffer = _explosion_sound ;
-                                item.eo = natus::audio::execution_options::play ;
-                                item.loop = false ;
-                                _audio_play_queue.emplace_back( item ) ;
-                            }
+                            _audio_queue.push( audio_queue_t::producer::physics, _ufo_sid, natus::audio::execution_options::stop ) ;
+                            _audio_queue.push( audio_queue_t::producer::physics, _explosion_sid, natus::audio::execution_options::play ) ;
                         }
                     }
                     if( hit ) continue ;
@@ -747,12 +1057,7 @@ namespace space_intruders
                             --_player.comp.num_lifes ;
                             _shots[i--] = _shots[--end] ;
 
-                            {
-                                audio_queue_item item ;
-                                item.buffer = _hit_player_sound ;
-                                item.eo = natus::audio::execution_options::play ;
-                                _audio_play_queue.emplace_back( item ) ;
-                            }
+                            _audio_queue.push( audio_queue_t::producer::physics, _hit_player_sid, natus::audio::execution_options::play ) ;
 
                             break ;
                         }
@@ -760,35 +1065,28 @@ namespace space_intruders
                     }
                 }
                 _shots.resize( end ) ;
-            }
+            }, { intruders, ufo, player, defense, projectiles } ) ;
         }
 
-        void_t on_audio( natus::audio::async_access_t audio ) noexcept
+        // captures everything that is drawn into the producer slot and 
+        // publishes it. Slots are reused so no allocation after warm up.
+        void_t publish_snapshot( void_t ) noexcept
         {
-            for( auto & b : _audio_play_queue )
-            {
-                natus::audio::backend::execute_detail ed ;
-                ed.to = b.eo ;
-                ed.loop = b.loop ;
-                audio.execute( b.buffer, ed ) ;
-            }
-            _audio_play_queue.clear() ;
-        }
+            auto & snap = _snapshots.write_slot() ;
+            snap.sprites.clear() ;
+            snap.boxes.clear() ;
 
-        void_t on_graphics( natus::gfx::sprite_render_2d_res_t sr, natus::gfx::sprite_sheets_cref_t sheets, size_t const milli_dt ) noexcept
-        {
-            size_t const sheet = 0 ;
+            auto const add = [&]( natus::math::vec2f_t const & prev_pos, natus::math::vec2f_t const & pos, float_t const scale, 
+                natus::gfx::sprite_sheet::sprite const & s, natus::math::vec4f_t const & color )
+            {
+                snap.sprites.emplace_back( sprite_item_t { prev_pos, pos, natus::math::vec2f_t( scale ), s.rect, s.pivot, color } ) ;
+            } ;
 
             // shots
-            for( auto & s : _shots )
+            for( auto const & s : _shots )
             {
-                sr->draw( 0, 
-                    s.pos, 
-                    natus::math::mat2f_t().identity(),
-                    natus::math::vec2f_t(s.scale),
-                    s.cur_sprite.rect,  
-                    sheet, s.cur_sprite.pivot, 
-                    natus::math::vec4f_t(1.0f) ) ;
+                add( s.prev_pos, s.pos, s.scale, s.cur_sprite, natus::math::vec4f_t(1.0f) ) ;
+                snap.boxes.emplace_back( s.get_bb() ) ;
             }
 
             // intruders
@@ -802,136 +1100,92 @@ namespace space_intruders
                     natus::math::vec4f_t( 1.0f, 0.0f, 0.0f, 1.0f ) 
                 } ;
 
-                for( size_t y=0; y<_intruders_h; ++y )
+                for( auto const & intr : _intruders )
                 {
-                    for( size_t x=0; x<_intruders_w; ++x )
-                    {
-                        size_t const idx = y * _intruders_w + x ;
-                        auto const & intr = _intruders[ idx ] ;
+                    snap.boxes.emplace_back( intr.get_bb() ) ;
+                    if( intr.hit ) continue ;
 
-                        if( !intr.hit )
-                        {
-                            sr->draw( 0, 
-                                intr.pos, 
-                                natus::math::mat2f_t().identity(),
-                                natus::math::vec2f_t(intr.scale),
-                                intr.cur_sprite.rect,  
-                                sheet, intr.cur_sprite.pivot, 
-                                colors[5 - (intr.obj_id % 6)] ) ;
-                        }
-                    }
+                    add( intr.prev_pos, intr.pos, intr.scale, intr.cur_sprite, colors[5 - (intr.obj_id % 6)] ) ;
                 }
             }
 
             // ufo
             if( _ufo_spawned && _ufo.ani_id != size_t(-1) )
             {
-                sr->draw( 0, 
-                    _ufo.pos, 
-                    natus::math::mat2f_t().identity(),
-                    natus::math::vec2f_t(_ufo.scale),
-                    _ufo.cur_sprite.rect,  
-                    sheet, _ufo.cur_sprite.pivot, 
-                    natus::math::vec4f_t(1.0f) ) ;
+                add( _ufo.prev_pos, _ufo.pos, _ufo.scale, _ufo.cur_sprite, natus::math::vec4f_t(1.0f) ) ;
+                snap.boxes.emplace_back( _ufo.get_bb() ) ;
             }
 
             // player
             if( _player.ani_id != size_t(-1) )
             {
-                sr->draw( 0, 
-                    _player.pos, 
-                    natus::math::mat2f_t().identity(),
-                    natus::math::vec2f_t(_player.scale),
-                    _player.cur_sprite.rect,  
-                    sheet, _player.cur_sprite.pivot, 
-                    natus::math::vec4f_t(1.0f) ) ;
+                add( _player.prev_pos, _player.pos, _player.scale, _player.cur_sprite, natus::math::vec4f_t(1.0f) ) ;
+                snap.boxes.emplace_back( _player.get_bb() ) ;
 
                 for( size_t i=0; i<_player.comp.num_lifes; ++i )
                 {
-                    sr->draw( 0, 
-                        natus::math::vec2f_t(-390.0f, 283.0f ) + natus::math::vec2f_t( float_t(i)*10.0f, 0.0f ), 
-                        natus::math::mat2f_t().identity(),
-                        natus::math::vec2f_t(_player.scale*0.25f),
-                        _player.cur_sprite.rect,  
-                        sheet, _player.cur_sprite.pivot, 
-                        natus::math::vec4f_t(1.0f) ) ;
+                    auto const p = natus::math::vec2f_t(-390.0f, 283.0f ) + natus::math::vec2f_t( float_t(i)*10.0f, 0.0f ) ;
+                    add( p, p, _player.scale*0.25f, _player.cur_sprite, natus::math::vec4f_t(1.0f) ) ;
                 }
             }
 
             // defense
-            for( auto & d : _defenses )
             {
-                if( d.comp.hits >= 3 ) continue ;
-
                 natus::math::vec4f_t const colors[3] = {
                     natus::math::vec4f_t( 0.0f, 1.0f, 0.0f, 1.0f ), 
                     natus::math::vec4f_t( 1.0f, 1.0f, 0.0f, 1.0f ), 
                     natus::math::vec4f_t( 1.0f, 0.0f, 0.0f, 1.0f ) 
                 } ;
 
-                sr->draw( 0, 
-                    d.pos, 
-                    natus::math::mat2f_t().identity(),
-                    natus::math::vec2f_t(d.scale),
-                    d.cur_sprite.rect,  
-                    sheet, d.cur_sprite.pivot, 
-                    colors[d.comp.hits%3] ) ;
-            }
-        }
-
-        void_t on_debug_graphics( natus::gfx::primitive_render_2d_res_t pr, natus::gfx::sprite_sheets_cref_t sheets, size_t const milli_dt ) noexcept
-        {
-            size_t const sheet = 0 ;
-
-            // player box
-            if( _player.ani_id != size_t(-1) )
-            {
-                auto const bb = _player.get_bb() ;
-
-                natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
-                natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
+                for( auto const & d : _defenses )
+                {
+                    snap.boxes.emplace_back( d.get_bb() ) ;
+                    if( d.comp.hits >= 3 ) continue ;
 
-                pr->draw_rect( 50, bb.box[0], bb.box[1], bb.box[2], bb.box[3], color0, color1 ) ;
+                    add( d.pos, d.pos, d.scale, d.cur_sprite, colors[d.comp.hits%3] ) ;
+                }
             }
 
-            // ufo box
-            if( _ufo_spawned && _ufo.ani_id != size_t(-1) )
-            {
-                auto const bb = _ufo.get_bb() ;
+            snap.score = _score ;
 
-                natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
-                natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
+            _snapshots.publish() ;
+        }
 
-                pr->draw_rect( 50, bb.box[0], bb.box[1], bb.box[2], bb.box[3], color0, color1 ) ;
-            }
-            
-            for( auto & intr : _intruders )
-            {
-                auto const bb = intr.get_bb() ;
+        void_t on_audio( natus::audio::async_access_t audio ) noexcept
+        {
+            _audio_queue.drain( audio ) ;
+        }
 
-                natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
-                natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
+        // draws the latest published snapshot interpolated by alpha between
+        // the previous and the current physics step.
+        void_t on_graphics( natus::gfx::sprite_render_2d_res_t sr, float_t const alpha ) noexcept
+        {
+            size_t const sheet = 0 ;
 
-                pr->draw_rect( 50, bb.box[0], bb.box[1], bb.box[2], bb.box[3], color0, color1 ) ;
-            }
+            _drawn = &_snapshots.read() ;
 
-            for( auto & d : _defenses )
+            for( auto const & s : _drawn->sprites )
             {
-                auto const bb = d.get_bb() ;
-
-                natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
-                natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
-
-                pr->draw_rect( 50, bb.box[0], bb.box[1], bb.box[2], bb.box[3], color0, color1 ) ;
+                sr->draw( 0, 
+                    s.prev_pos + (s.pos - s.prev_pos) * natus::math::vec2f_t( alpha ), 
+                    natus::math::mat2f_t().identity(),
+                    s.scale,
+                    s.rect,  
+                    sheet, s.pivot, 
+                    s.color ) ;
             }
+        }
 
-            for( auto & p : _shots )
-            {
-                auto const bb = p.get_bb() ;
+        // requires on_graphics to be called before in the same frame
+        void_t on_debug_graphics( natus::gfx::primitive_render_2d_res_t pr, natus::gfx::sprite_sheets_cref_t, size_t const ) noexcept
+        {
+            if( _drawn == nullptr ) return ;
 
-                natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
-                natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
+            natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
+            natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
 
+            for( auto const & bb : _drawn->boxes )
+            {
                 pr->draw_rect( 50, bb.box[0], bb.box[1], bb.box[2], bb.box[3], color0, color1 ) ;
             }
         }
@@ -946,6 +1200,19 @@ namespace space_intruders
     {
         natus_this_typedefs( the_game ) ;
 
+        typedef std::chrono::high_resolution_clock clock_t ;
+
+    private: // startup
+
+        startup_trace_ptr_t _trace ;
+
+    private: // timing
+
+        // physics runs in fixed steps, logic gets whole milliseconds and
+        // carries the rest to the next call
+        fixed_step_t _physics_step { 60 } ;
+        size_t _logic_us = 0 ;
+
     private: // device
         
         natus::device::three_device_res_t _dev_mouse ;
@@ -986,12 +1253,19 @@ namespace space_intruders
     private: // sprite tool
 
         natus::tool::sprite_editor_res_t _se ;
-        natus::gfx::sprite_sheets_res_t _sheets ;
+
+    private: // sprite sheet hot reload
+
+        sheet_reload_t _sheet_reload ;
+        natus::graphics::image_object_res_t _image_array ;
 
     private: // game
 
         field_t _field ;
 
+        // a wave of 100k intruders for profiling the parallel loops
+        bool_t _stress = false ;
+
     private: // audio
 
         natus::audio::async_access_t _audio ;
@@ -1034,6 +1308,10 @@ namespace space_intruders
 
             _audio = this_t::create_audio_engine() ;
         }
+        the_game( bool_t const stress ) : this_t()
+        {
+            _stress = stress ;
+        }
         the_game( this_cref_t ) = delete ;
         the_game( this_rref_t rhv ) : app( std::move( rhv ) ) 
         {
@@ -1051,6 +1329,7 @@ namespace space_intruders
             _se = std::move( rhv._se ) ;
 
             _field = std::move( rhv._field ) ;
+            _stress = rhv._stress ;
 
             _audio = std::move( rhv._audio ) ;
         }
@@ -1096,8 +1375,32 @@ namespace space_intruders
 
     private:
 
+        //********************************************************************************
+        // takes over a finished sprite sheet reload. The image array is only 
+        // re-uploaded if an image changed.
+        void_t hot_reload_sprite_sheets( void_t ) noexcept
+        {
+            if( !_image_array.is_valid() ) return ;
+
+            sheet_reload_t::change_t c ;
+            if( !_sheet_reload.poll( c ) ) return ;
+
+            if( c.images_changed )
+            {
+                _image_array = sheet_reload_t::make_image_array( std::move( c.imgs ) ) ;
+                _graphics.for_each( [&]( natus::graphics::async_view_t a )
+                {
+                    a.configure( _image_array ) ;
+                } ) ;
+            }
+
+            _field.on_sprite_sheets_changed() ;
+        }
+
         virtual natus::application::result on_init( void_t ) noexcept
         { 
+            _trace = std::make_shared< startup_trace_t >( "space_intruders", DATAPATH "/startup_report.json" ) ;
+
             natus::device::xbc_device_res_t xbc_dev ;
             natus::device::ascii_device_res_t ascii_dev ;
             natus::device::three_device_res_t three_dev ;
@@ -1133,6 +1436,8 @@ namespace space_intruders
 
             // root render states
             {
+                auto const ph = _trace->begin( "root render states" ) ;
+
                 natus::graphics::state_object_t so = natus::graphics::state_object_t(
                     "root_render_states" ) ;
 
@@ -1162,10 +1467,14 @@ namespace space_intruders
                 {
                     a.configure( _root_render_states ) ;
                 } ) ;
+
+                _trace->end( ph ) ;
             }
 
             // framebuffer render states
             {
+                auto const ph = _trace->begin( "framebuffer render states" ) ;
+
                 natus::graphics::state_object_t so = natus::graphics::state_object_t(
                     "fb_render_states" ) ;
 
@@ -1200,158 +1509,60 @@ namespace space_intruders
                 {
                     a.configure( _fb_render_states ) ;
                 } ) ;
+
+                _trace->end( ph ) ;
             }
             
             // import natus file
             {
-                _sheets = natus::gfx::sprite_sheets_t() ;
-
-                natus::format::module_registry_res_t mod_reg = natus::format::global_t::registry() ;
-                auto item = mod_reg->import_from( natus::io::location_t( "sprite_sheet.natus" ), _db ) ;
+                _sheet_reload.init( _db, _trace ) ;
 
-                natus::format::natus_item_res_t ni = item.get() ;
-                if( ni.is_valid() )
+                natus::graphics::image_t imgs ;
+                if( _sheet_reload.load( imgs ) )
                 {
-                    natus::format::natus_document_t doc = std::move( ni->doc ) ;
+                    auto const ph_img = _trace->begin( "image array" ) ;
+                    size_t const img_bytes = size_t( imgs.get_dims().x() * imgs.get_dims().y() * imgs.get_dims().z() ) * 4 ;
 
-                    // taking all slices
-                    natus::graphics::image_t imgs ;
-
-                    // load images
-                    {
-                        natus::ntd::vector< natus::format::future_item_t > futures ;
-                        for( auto const & ss : doc.sprite_sheets )
-                        {
-                            auto const l = natus::io::location_t::from_path( natus::io::path_t(ss.image.src) ) ;
-                            futures.emplace_back( mod_reg->import_from( l, _db ) ) ;
-                        }
-
-                    
-                        for( size_t i=0; i<doc.sprite_sheets.size(); ++i )
-                        {
-                            natus::format::image_item_res_t ii = futures[i].get() ;
-                            if( ii.is_valid() )
-                            {
-                                imgs.append( *ii->img ) ;
-                            }
-
-                            natus::gfx::sprite_sheet ss ;
-                            _sheets->emplace_back( ss ) ;
-                        }
-                    }
-
-                    // make sprite animation infos
-                    {
-                        // as an image array is used, the max dims need to be
-                        // used to compute the particular rect infos
-                        auto dims = imgs.get_dims() ;
-                    
-                        size_t i=0 ;
-                        for( auto const & ss : doc.sprite_sheets )
-                        {
-                            auto & sheet = (*_sheets)[i++] ;
-
-                            for( auto const & s : ss.sprites )
-                            {
-                                natus::math::vec4f_t const rect = 
-                                    (natus::math::vec4f_t( s.animation.rect ) + 
-                                        natus::math::vec4f_t(0.0f,0.0f, 1.0f, 1.0f))/ 
-                                    natus::math::vec4f_t( dims.xy(), dims.xy() )  ;
-
-                                natus::math::vec2f_t const pivot =
-                                    natus::math::vec2f_t( s.animation.pivot ) / 
-                                    natus::math::vec2f_t( dims.xy() ) ;
-
-                                natus::gfx::sprite_sheet::sprite s_ ;
-                                s_.rect = rect ;
-                                s_.pivot = pivot ;
-
-                                sheet.rects.emplace_back( s_ ) ;
-                            }
-
-                            natus::ntd::map< natus::ntd::string_t, size_t > object_map ;
-
-                            for( auto const & a : ss.animations )
-                            {
-                                size_t obj_id = 0 ;
-                                {
-                                    auto iter = object_map.find( a.object ) ;
-                                    if( iter != object_map.end() ) obj_id = iter->second ;
-                                    else 
-                                    {
-                                        obj_id = sheet.objects.size() ;
-                                        sheet.objects.emplace_back( natus::gfx::sprite_sheet::object { a.object, {} } ) ;
-                                    }
-                                }
-
-                                natus::gfx::sprite_sheet::animation a_ ;
-
-                                size_t tp = 0 ;
-                                for( auto const & f : a.frames )
-                                {
-                                    auto iter = std::find_if( ss.sprites.begin(), ss.sprites.end(), 
-                                        [&]( natus::format::natus_document_t::sprite_sheet_t::sprite_cref_t s )
-                                    {
-                                        return s.name == f.sprite ;
-                                    } ) ;
-                                    if( iter == ss.sprites.end() )
-                                    {
-                                        natus::log::global_t::error("can not find sprite [" + f.sprite + "]" ) ;
-                                        continue ;
-                                    }
-                                    size_t const d = std::distance( ss.sprites.begin(), iter ) ;
-                                    natus::gfx::sprite_sheet::animation::sprite s_ ;
-                                    s_.begin = tp ;
-                                    s_.end = tp + f.duration ;
-                                    s_.idx = d ;
-                                    a_.sprites.emplace_back( s_ ) ;
-
-                                    tp = s_.end ;
-                                }
-                                a_.duration = tp ;
-                                a_.name = a.name ;
-
-                                sheet.objects[obj_id].animations.emplace_back( std::move( a_ ) ) ;
-                            }
-                        }
-                    }
-
-                    natus::graphics::image_object_res_t ires = natus::graphics::image_object_t( 
-                        "image_array", std::move( imgs ) )
-                        .set_type( natus::graphics::texture_type::texture_2d_array )
-                        .set_wrap( natus::graphics::texture_wrap_mode::wrap_s, natus::graphics::texture_wrap_type::repeat )
-                        .set_wrap( natus::graphics::texture_wrap_mode::wrap_t, natus::graphics::texture_wrap_type::repeat )
-                        .set_filter( natus::graphics::texture_filter_mode::min_filter, natus::graphics::texture_filter_type::nearest )
-                        .set_filter( natus::graphics::texture_filter_mode::mag_filter, natus::graphics::texture_filter_type::nearest );
+                    _image_array = sheet_reload_t::make_image_array( std::move( imgs ) ) ;
 
                     _graphics.for_each( [&]( natus::graphics::async_view_t a )
                     {
-                        a.configure( ires ) ;
+                        a.configure( _image_array ) ;
                     } ) ;
+
+                    _trace->end( ph_img, img_bytes ) ;
                 }
             }
 
             // prepare sprite render
             {
+                auto const ph = _trace->begin( "prepare sprite render" ) ;
+
                 _sr = natus::gfx::sprite_render_2d_res_t( natus::gfx::sprite_render_2d_t() ) ;
                 _sr->init( "sprite_render", "image_array", _graphics ) ;
+
+                _trace->end( ph ) ;
             }
             
             // prepare primitive
             {
+                auto const ph = _trace->begin( "prepare primitive" ) ;
+
                 _pr = natus::gfx::primitive_render_2d_res_t( natus::gfx::primitive_render_2d_t() ) ;
                 _pr->init( "prim_render", _graphics ) ;
+
+                _trace->end( ph ) ;
             }
 
             // import fonts and create text render
             {
+                auto const ph = _trace->begin( "font raster" ) ;
+
                 natus::property::property_sheet_res_t ps = natus::property::property_sheet_t() ;
 
                 {
-                    natus::font::code_points_t pts ;
-                    for( uint32_t i = 33; i <= 126; ++i ) pts.emplace_back( i ) ;
-                    for( uint32_t i : {uint32_t( 0x00003041 )} ) pts.emplace_back( i ) ;
-                    ps->set_value< natus::font::code_points_t >( "code_points", pts ) ;
+                    ps->set_value< natus::font::code_points_t >( "code_points", 
+                        make_code_points( { TITLE, "0123456789" } ) ) ;
                 }
 
                 #if 0
@@ -1379,10 +1590,14 @@ namespace space_intruders
                     _tr = natus::gfx::text_render_2d_res_t( natus::gfx::text_render_2d_t( "text_render", _graphics ) ) ;
                     _tr->init( std::move( *ii->obj ), NUM_LAYERS ) ;
                 }
+
+                _trace->end( ph, startup_trace_t::file_size( "fonts/LCD_Solid.ttf" ) ) ;
             }
 
             // framebuffer
             {
+                auto const ph = _trace->begin( "framebuffer" ) ;
+
                 _fb = natus::graphics::framebuffer_object_t( "the_scene" ) ;
                 _fb->set_target( natus::graphics::color_target_type::rgba_uint_8, 1 )
                     .resize( size_t(_screen_target.x()), size_t(_screen_target.y()) ) ;
@@ -1391,22 +1606,32 @@ namespace space_intruders
                 {
                     a.configure( _fb ) ;
                 } ) ;
+
+                _trace->end( ph, size_t(_screen_target.x()) * size_t(_screen_target.y()) * 4 ) ;
             }
 
             // prepare quad
             {
+                auto const ph = _trace->begin( "prepare quad" ) ;
+
                 _quad = natus::gfx::quad_res_t( natus::gfx::quad_t("post_map") ) ;
                 _quad->init( _graphics ) ;
                 _quad->set_texture("the_scene.0") ;
+
+                _trace->end( ph ) ;
             }
 
             // tool sprite
             {
+                auto const ph = _trace->begin( "tool sprite" ) ;
+
                 _se->add_sprite_sheet( "sprites", natus::io::location_t( "images.space_intruders.png" ) ) ;
                 //_se->add_sprite_sheet( "enemies", natus::io::location_t( "images.Paper-Pixels-8x8.Enemies.png" ) ) ;
                 //_se->add_sprite_sheet( "player", natus::io::location_t( "images.Paper-Pixels-8x8.Player.png" ) ) ;
                 //_se->add_sprite_sheet( "tiles", natus::io::location_t( "images.Paper-Pixels-8x8.Tiles.png" ) ) ;
                 
+
+                _trace->end( ph ) ;
             }
 
             {
@@ -1544,6 +1769,8 @@ namespace space_intruders
 
             // audio
             {
+                auto const ph = _trace->begin( "audio" ) ;
+
                 //
                 // prepare the audio buffer for playing
                 //
@@ -1597,20 +1824,38 @@ namespace space_intruders
                     _audio.configure( _explosion ) ;
                     _audio.configure( _hit_player ) ;
                 }
+
+                _trace->end( ph, startup_trace_t::file_size( "audio/laser.wav" ) + startup_trace_t::file_size( "audio/ufo.wav" ) + 
+                    startup_trace_t::file_size( "audio/explosion.wav" ) + startup_trace_t::file_size( "audio/hit_player.wav" ) ) ;
             }
 
             // should come last
             // field data
             {
+                auto const ph = _trace->begin( "field data" ) ;
+
                 space_intruders::field_t::init_data_t field_init_data ;
-                field_init_data.sheets = _sheets  ;
+                field_init_data.sheets = _sheet_reload.current() ;
                 field_init_data.laser = _laser ;
                 field_init_data.ufo = _ufo ;
                 field_init_data.explosion = _explosion ;
                 field_init_data.hit_player = _hit_player ;
+
+                if( _stress )
+                {
+                    field_init_data.intruders_w = 400 ;
+                    field_init_data.intruders_h = 250 ;
+                    field_init_data.report_speedup = true ;
+                }
+
                 _field.on_init( std::move( field_init_data ) ) ;
+
+                _trace->end( ph ) ;
             }
 
+            // app phases are done. game phases may still run in the background.
+            _trace->seal() ;
+
             return natus::application::result::ok ; 
         }
 
@@ -1647,7 +1892,13 @@ namespace space_intruders
 
         virtual natus::application::result on_logic( logic_data_in_t d ) noexcept 
         { 
-            _field.on_logic( *_sheets, d.micro_dt / 1000 ) ;
+            this_t::hot_reload_sprite_sheets() ;
+
+            _logic_us += d.micro_dt ;
+            size_t const milli_dt = _logic_us / 1000 ;
+            _logic_us -= milli_dt * 1000 ;
+
+            _field.on_logic( milli_dt ) ;
 
             NATUS_PROFILING_COUNTER_HERE( "Logic Clock" ) ;
             return natus::application::result::ok ; 
@@ -1662,7 +1913,10 @@ namespace space_intruders
 
         virtual natus::application::result on_physics( natus::application::app_t::physics_data_in_t pd ) noexcept
         { 
-            _field.on_physics( pd.micro_dt / 1000 ) ;
+            _physics_step.advance( pd.micro_dt, [&]( size_t const step_us )
+            {
+                _field.on_physics( step_us ) ;
+            } ) ;
             NATUS_PROFILING_COUNTER_HERE( "Physics Clock" ) ;
             return natus::application::result::ok ; 
         }
@@ -1699,7 +1953,7 @@ namespace space_intruders
 
             {
                 _tr->draw_text( 0, 0, 10, natus::math::vec2f_t(-.2f, 0.7f), 
-                    natus::math::vec4f_t(1.0f), "space intruders" ) ;
+                    natus::math::vec4f_t(1.0f), TITLE ) ;
             }
 
             #if 0 // test animation
@@ -1732,16 +1986,16 @@ namespace space_intruders
             #endif
 
             {
-                _field.on_graphics( _sr, *_sheets, rdi.milli_dt ) ;
+                _field.on_graphics( _sr, _physics_step.alpha() ) ;
                 
                 _tr->draw_text( 0, 0, 10, natus::math::vec2f_t(-.85f, 0.7f), 
-                    natus::math::vec4f_t(1.0f), std::to_string( _field.get_score()) ) ;
+                    natus::math::vec4f_t(1.0f), std::to_string( _field.get_drawn_score()) ) ;
             
             }
 
             if( _draw_debug )
             {
-                _field.on_debug_graphics( _pr, *_sheets, rdi.milli_dt) ;
+                _field.on_debug_graphics( _pr, *_sheet_reload.sheets(), rdi.milli_dt) ;
             }
 
             // draw extend of aspect
@@ -1834,6 +2088,11 @@ namespace space_intruders
 
 int main( int argc, char ** argv )
 {
+    // --stress : start with 100k intruders and log the parallel speedup
+    bool stress = false ;
+    for( int i=1; i<argc; ++i ) 
+        stress = stress || std::strcmp( argv[i], "--stress" ) == 0 ;
+
     return natus::application::global_t::create_application( 
-        space_intruders::the_game_res_t( space_intruders::the_game_t() ) )->exec() ;
+        space_intruders::the_game_res_t( space_intruders::the_game_t( stress ) ) )->exec() ;
 }
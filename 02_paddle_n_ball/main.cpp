@@ -37,13 +37,56 @@
 #include <natus/math/utility/angle.hpp>
 #include <natus/math/utility/3d/transformation.hpp>
 
+#include <common/audio_queue.hpp>
+#include <common/fixed_step.hpp>
+#include <common/code_points.hpp>
+#include <common/parallel_for.hpp>
+#include <common/input_queue.hpp>
+#include <common/startup_trace.hpp>
+#include <common/versioned_ptr.hpp>
+#include <common/sheet_reload.hpp>
+#include <common/triple_buffer.hpp>
+
 #include <thread>
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <fstream>
+#include <cstring>
+#include <limits>
+#include <cmath>
+#include <array>
+#include <algorithm>
 
 namespace paddle_n_ball
 {
     static size_t const NUM_LAYERS = 100 ;
 
+    // all text drawn besides the score
+    static char const * const TITLE = "Paddle'n'Ball" ;
+
     using namespace natus::core::types ;
+    using namespace games ;
+
+    // handed to background work that may be superseded. The work tests it
+    // at its task boundaries and stops once it is cancelled.
+    class cancel_token
+    {
+        natus_this_typedefs( cancel_token ) ;
+
+    private:
+
+        std::atomic< bool_t > _cancelled { false } ;
+
+    public:
+
+        void_t cancel( void_t ) noexcept { _cancelled = true ; }
+        bool_t is_cancelled( void_t ) const noexcept { return _cancelled ; }
+    };
+    natus_typedef( cancel_token ) ;
+    typedef std::shared_ptr< cancel_token_t > cancel_token_ptr_t ;
 
     class the_game
     {
@@ -76,6 +119,9 @@ namespace paddle_n_ball
 
             natus::math::vec2f_t pos ;
 
+            // the position before the last physics step
+            natus::math::vec2f_t prev_pos ;
+
             size_t obj_id = size_t( -1 ) ;
             size_t ani_id = size_t( -1 ) ;
             size_t anim_time = 0 ;
@@ -96,6 +142,11 @@ namespace paddle_n_ball
                 return { p0, p1, p2, p3 } ;
             }
 
+            natus::math::vec2f_t lerp_pos( float_t const alpha ) const noexcept
+            {
+                return prev_pos + (pos - prev_pos) * natus::math::vec2f_t( alpha ) ;
+            }
+
             natus::collide::n2d::aabbf_t get_aabb( void_t ) const noexcept
             {
                 auto const rdims = cur_sprite.rect.zw() - cur_sprite.rect.xy() ;
@@ -105,6 +156,50 @@ namespace paddle_n_ball
                 return natus::collide::n2d::aabbf_t( p0, p2 ) ;
             }
 
+            // picks the sprite of the current animation time and advances it
+            void_t animate( natus::gfx::sprite_sheet_cref_t sheet, size_t const milli_dt ) noexcept
+            {
+                if( ani_id == size_t(-1) ) return ;
+
+                cur_sprite = sheet.determine_sprite( obj_id, ani_id, anim_time ) ;
+                anim_time = (anim_time + milli_dt) % max_ani_time ;
+            }
+
+            // re-resolves the ids by object and animation name after the
+            // sprite sheet was re-baked. Falls back to 0 if a name is gone.
+            void_t remap( natus::gfx::sprite_sheet_cref_t from, natus::gfx::sprite_sheet_cref_t to ) noexcept
+            {
+                if( obj_id >= from.objects.size() ) return ;
+                auto const & fo = from.objects[obj_id] ;
+
+                auto const oiter = std::find_if( to.objects.begin(), to.objects.end(), 
+                    [&]( natus::gfx::sprite_sheet::object const & o )
+                {
+                    return o.name == fo.name ;
+                } ) ;
+                obj_id = oiter == to.objects.end() ? 0 : std::distance( to.objects.begin(), oiter ) ;
+                if( obj_id >= to.objects.size() ) return ;
+
+                auto const & to_ = to.objects[obj_id] ;
+
+                size_t new_ani = 0 ;
+                if( ani_id < fo.animations.size() )
+                {
+                    auto const aiter = std::find_if( to_.animations.begin(), to_.animations.end(), 
+                        [&]( natus::gfx::sprite_sheet::animation const & a )
+                    {
+                        return a.name == fo.animations[ani_id].name ;
+                    } ) ;
+                    if( aiter != to_.animations.end() ) new_ani = std::distance( to_.animations.begin(), aiter ) ;
+                }
+                ani_id = new_ani ;
+                if( ani_id >= to_.animations.size() ) return ;
+
+                size_t const d = to_.animations[ani_id].duration ;
+                max_ani_time = d == 0 ? 1 : d ;
+                anim_time = anim_time % max_ani_time ;
+            }
+
             static natus::ntd::vector< this_t > load_from( natus::gfx::sprite_sheet_cref_t sheet, 
                 natus::ntd::vector< natus::ntd::string_t > names,
                 natus::ntd::vector< natus::ntd::string_t > animations ) noexcept
@@ -153,32 +248,298 @@ namespace paddle_n_ball
 
         private: // bricks
 
+            // A level is held bit-packed with 1, 2 or 4 bits per cell so a cell
+            // never straddles a byte. A cell value of 0 is an empty space, any
+            // other value is a brick of that kind.
+            //
+            // Binary level file (layouts/level_N.bin), all numbers little endian:
+            // 4 byte : 'P' 'N' 'B' 'L'
+            // 1 byte : version
+            // 1 byte : bits per cell
+            // 1 byte : flags, bit 0 : payload is run-length encoded
+            // 1 byte : reserved
+            // 4 byte : width
+            // 4 byte : height
+            // payload : the packed cells or 
+            //           run-length pairs of ( 4 byte count, 1 byte cell value )
             struct level
             {
+                natus_this_typedefs( level ) ;
+
                 size_t w = 0 ;
                 size_t h = 0 ;
 
-                natus::ntd::vector< size_t > layout ;
+                size_t bits = 1 ;
+                natus::ntd::vector< uint8_t > cells ;
+
+                static const size_t version = 1 ;
+                static const size_t flag_rle = 1 ;
+                static const size_t header_size = 16 ;
+
+                // a binary header asking for more is rejected
+                static const size_t max_cells = size_t( 1 ) << 24 ;
+
+                size_t num_cells( void_t ) const noexcept { return w * h ; }
+
+                void_t resize( size_t const w_, size_t const h_, size_t const bits_ ) noexcept
+                {
+                    w = w_ ;
+                    h = h_ ;
+                    bits = bits_ ;
+                    cells.clear() ;
+                    cells.resize( (w * h * bits + 7) / 8, 0 ) ;
+                }
+
+                size_t get( size_t const i ) const noexcept
+                {
+                    size_t const b = i * bits ;
+                    return size_t( cells[ b >> 3 ] >> (b & 7) ) & ((size_t(1) << bits) - 1) ;
+                }
+
+                void_t set( size_t const i, size_t const v ) noexcept
+                {
+                    size_t const b = i * bits ;
+                    uint8_t const mask = uint8_t( ((size_t(1) << bits) - 1) << (b & 7) ) ;
+                    cells[ b >> 3 ] = uint8_t( (cells[ b >> 3 ] & ~mask) | ((v << (b & 7)) & mask) ) ;
+                }
+
+                // calls funk( idx, value ) for every occupied cell. Empty bytes 
+                // are skipped as a whole so sparse levels are cheap to walk.
+                template< typename funk_t >
+                void_t for_each_occupied( funk_t funk ) const noexcept
+                {
+                    size_t const per_byte = 8 / bits ;
+                    size_t const n = this_t::num_cells() ;
+
+                    for( size_t i=0; i<cells.size(); ++i )
+                    {
+                        if( cells[i] == 0 ) continue ;
+
+                        size_t const end = std::min( (i+1) * per_byte, n ) ;
+                        for( size_t c=i*per_byte; c<end; ++c )
+                        {
+                            size_t const v = this_t::get( c ) ;
+                            if( v != 0 ) funk( c, v ) ;
+                        }
+                    }
+                }
+
+                size_t count_occupied( void_t ) const noexcept
+                {
+                    size_t ret = 0 ;
+                    this_t::for_each_occupied( [&]( size_t const, size_t const ){ ++ret ; } ) ;
+                    return ret ;
+                }
+
+                // '.' or ' ' is empty, '#' is a brick of kind 1, 
+                // '1'-'9' and 'a'-'f' are bricks of that kind.
+                static size_t cell_from_char( char const c ) noexcept
+                {
+                    if( c >= '1' && c <= '9' ) return size_t( c - '0' ) ;
+                    if( c >= 'a' && c <= 'f' ) return size_t( c - 'a' ) + 10 ;
+                    if( c == '.' || c == ' ' ) return 0 ;
+                    return 1 ;
+                }
+
+                // converts the text layout into a packed level using the least
+                // number of bits that can hold the highest brick kind.
+                static bool_t from_text( char_cptr_t data, size_t const sib, this_ref_t l ) noexcept
+                {
+                    size_t w = 0 ;
+                    size_t h = 0 ;
+                    size_t max_value = 0 ;
+
+                    {
+                        size_t cur = 0 ;
+                        for( size_t i=0; i<=sib; ++i )
+                        {
+                            char const c = i < sib ? data[i] : '\n' ;
+                            if( c == '\r' ) continue ;
+                            if( c == '\n' )
+                            {
+                                if( cur != 0 ) ++h ;
+                                w = std::max( w, cur ) ;
+                                cur = 0 ;
+                                continue ;
+                            }
+                            max_value = std::max( max_value, this_t::cell_from_char( c ) ) ;
+                            ++cur ;
+                        }
+                    }
+
+                    if( w == 0 || h == 0 ) return false ;
+
+                    l.resize( w, h, max_value < 2 ? 1 : max_value < 4 ? 2 : 4 ) ;
+
+                    {
+                        size_t x = 0 ;
+                        size_t y = 0 ;
+                        for( size_t i=0; i<sib; ++i )
+                        {
+                            char const c = data[i] ;
+                            if( c == '\r' ) continue ;
+                            if( c == '\n' )
+                            {
+                                if( x != 0 ) ++y ;
+                                x = 0 ;
+                                continue ;
+                            }
+                            l.set( y * w + x++, this_t::cell_from_char( c ) ) ;
+                        }
+                    }
+
+                    return true ;
+                }
+
+                static bool_t from_binary( char_cptr_t data, size_t const sib, this_ref_t l ) noexcept
+                {
+                    auto const * ptr = reinterpret_cast< uint8_t const * >( data ) ;
+                    auto read_u32 = [&]( size_t const off )
+                    {
+                        return size_t( ptr[off] ) | size_t( ptr[off+1] ) << 8 | 
+                            size_t( ptr[off+2] ) << 16 | size_t( ptr[off+3] ) << 24 ;
+                    } ;
+
+                    if( sib < header_size || ptr[0] != 'P' || ptr[1] != 'N' || ptr[2] != 'B' || ptr[3] != 'L' )
+                    {
+                        natus::log::global_t::error( "[level] : not a binary level file" ) ;
+                        return false ;
+                    }
+
+                    if( ptr[4] != version )
+                    {
+                        natus::log::global_t::error( "[level] : unsupported version " + std::to_string( ptr[4] ) ) ;
+                        return false ;
+                    }
+
+                    size_t const bits = ptr[5] ;
+                    if( bits != 1 && bits != 2 && bits != 4 )
+                    {
+                        natus::log::global_t::error( "[level] : invalid bits per cell" ) ;
+                        return false ;
+                    }
+
+                    // checked before anything is allocated. w > max / h can 
+                    // not overflow like w * h could.
+                    size_t const w = read_u32( 8 ) ;
+                    size_t const h = read_u32( 12 ) ;
+                    if( w == 0 || h == 0 || w > max_cells / h )
+                    {
+                        natus::log::global_t::error( "[level] : invalid size " + std::to_string( w ) + "x" + 
+                            std::to_string( h ) ) ;
+                        return false ;
+                    }
+
+                    size_t const n = w * h ;
+                    size_t const payload = sib - header_size ;
+
+                    if( (ptr[6] & flag_rle) == 0 )
+                    {
+                        if( payload != (n * bits + 7) / 8 ) 
+                        {
+                            natus::log::global_t::error( "[level] : payload does not match the size" ) ;
+                            return false ;
+                        }
+
+                        l.resize( w, h, bits ) ;
+                        std::memcpy( l.cells.data(), ptr + header_size, l.cells.size() ) ;
+                        return true ;
+                    }
+
+                    if( payload % 5 != 0 )
+                    {
+                        natus::log::global_t::error( "[level] : broken run-length payload" ) ;
+                        return false ;
+                    }
+
+                    l.resize( w, h, bits ) ;
+
+                    // decode runs straight into the packed cells. Empty runs
+                    // only need to be skipped as the cells are zeroed already.
+                    size_t c = 0 ;
+                    size_t off = header_size ;
+                    for( ; off < sib; off += 5 )
+                    {
+                        size_t const count = read_u32( off ) ;
+                        if( count > n - c ) break ;
+
+                        size_t const v = ptr[off+4] ;
+                        if( v != 0 ) for( size_t i=0; i<count; ++i ) l.set( c+i, v ) ;
+                        c += count ;
+                    }
+
+                    // the runs must cover the cells exactly
+                    if( c != n || off != sib )
+                    {
+                        natus::log::global_t::error( "[level] : run-length payload does not match the size" ) ;
+                        return false ;
+                    }
+
+                    return true ;
+                }
+
+                natus::ntd::vector< char > to_binary( bool_t const rle ) const noexcept
+                {
+                    natus::ntd::vector< char > ret ;
+                    ret.reserve( header_size + cells.size() ) ;
+
+                    auto write_u32 = [&]( size_t const v )
+                    {
+                        for( size_t i=0; i<4; ++i ) ret.emplace_back( char( (v >> (i*8)) & 255 ) ) ;
+                    } ;
+
+                    for( char const c : {'P','N','B','L'} ) ret.emplace_back( c ) ;
+                    ret.emplace_back( char( version ) ) ;
+                    ret.emplace_back( char( bits ) ) ;
+                    ret.emplace_back( char( rle ? flag_rle : 0 ) ) ;
+                    ret.emplace_back( char( 0 ) ) ;
+                    write_u32( w ) ;
+                    write_u32( h ) ;
+
+                    if( !rle )
+                    {
+                        ret.insert( ret.end(), cells.begin(), cells.end() ) ;
+                        return ret ;
+                    }
+
+                    size_t const n = this_t::num_cells() ;
+                    for( size_t i=0; i<n; )
+                    {
+                        size_t const v = this_t::get( i ) ;
+                        size_t count = 1 ;
+                        while( i + count < n && count < 0xffffffff && this_t::get( i + count ) == v ) ++count ;
+
+                        write_u32( count ) ;
+                        ret.emplace_back( char( v ) ) ;
+                        i += count ;
+                    }
+
+                    return ret ;
+                }
             };
             natus_typedef( level ) ;
-            level_t _level ;
 
+            // only occupied cells own a brick
             struct brick
             {
                 bool_t is_visible = true ;
+
+                // cell index into the level and the brick kind
+                size_t cell = 0 ;
+                size_t kind = 1 ;
+
                 natus::audio::buffer_object_res_t hit_sound ;
                 natus::audio::buffer_object_res_t destruction_sound ;
             };
             natus_typedefs( entity< brick >, brick ) ;
             natus_typedefs( natus::ntd::vector< brick_t >, bricks ) ;
 
-            bricks_t _bricks ;
-
         private: // paddle
 
             struct paddle
             {
                 natus::audio::buffer_object_res_t hit_sound ;
+                uint16_t hit_sid = 0 ;
 
                 // direction
                 natus::math::vec2f_t adv ;
@@ -193,21 +554,113 @@ namespace paddle_n_ball
             struct ball
             {
                 natus::audio::buffer_object_res_t hit_sound ;
+                uint16_t hit_sid = 0 ;
                 natus::math::vec2f_t adv ;
             };
             natus_typedefs( entity< ball >, ball ) ;
-            natus_typedefs( natus::ntd::vector< ball_t >, balls ) ;
             ball_t _ball ;
 
-        private: // audio
+            // bounces resolved per physics step
+            static constexpr size_t MAX_BOUNCES = 4 ;
 
-            struct audio_queue_item
+            // what happened to a ball during one physics step
+            struct ball_hits
             {
-                natus::audio::buffer_object_res_t buffer ;
-                natus::audio::execution_options eo ;
-                bool_t loop = false ;
-            } ;
-            natus::ntd::vector< audio_queue_item > _audio_play_queue ;
+                bool_t bottom = false ;
+                bool_t paddle = false ;
+
+                // in the order they were hit
+                size_t num_bricks = 0 ;
+                std::array< size_t, MAX_BOUNCES > bricks ;
+            };
+            natus_typedef( ball_hits ) ;
+
+        private: // multi ball
+
+            // the extra balls. Stored as arrays so they can be moved in 
+            // parallel. They look like _ball.
+            struct ball_soa
+            {
+                natus::ntd::vector< natus::math::vec2f_t > pos ;
+                natus::ntd::vector< natus::math::vec2f_t > prev_pos ;
+                natus::ntd::vector< natus::math::vec2f_t > adv ;
+
+                // per ball scratch of the last step
+                natus::ntd::vector< ball_hits_t > hits ;
+
+                size_t size( void_t ) const noexcept { return pos.size() ; }
+
+                void_t add( natus::math::vec2f_t const & p, natus::math::vec2f_t const & a ) noexcept
+                {
+                    pos.emplace_back( p ) ;
+                    prev_pos.emplace_back( p ) ;
+                    adv.emplace_back( a ) ;
+                }
+
+                // removes the balls pred( i ) is true for and keeps the order
+                // of the others
+                template< typename pred_t >
+                void_t remove_if( pred_t pred ) noexcept
+                {
+                    size_t j = 0 ;
+                    for( size_t i=0; i<pos.size(); ++i )
+                    {
+                        if( pred( i ) ) continue ;
+
+                        pos[j] = pos[i] ;
+                        prev_pos[j] = prev_pos[i] ;
+                        adv[j] = adv[i] ;
+                        ++j ;
+                    }
+                    pos.resize( j ) ;
+                    prev_pos.resize( j ) ;
+                    adv.resize( j ) ;
+                }
+            };
+            natus_typedef( ball_soa ) ;
+            ball_soa_t _balls ;
+
+            size_t _max_balls = 100 ;
+            size_t _ball_grain = 256 ;
+
+            // every that many destroyed bricks the ball that destroyed the 
+            // last one splits
+            size_t _split_every = 10 ;
+            size_t _bricks_destroyed = 0 ;
+
+            // the stress preset keeps that many extra balls in play and 
+            // logs the time the extra balls take
+            size_t _stress_balls = 0 ;
+            size_t _balls_us = 0 ;
+            size_t _balls_steps = 0 ;
+
+        public:
+
+            void_t set_stress( bool_t const b ) noexcept 
+            { 
+                _stress_balls = b ? 10000 : 0 ;
+                _max_balls = std::max( _max_balls, _stress_balls ) ;
+            }
+
+        private: // audio
+
+            // shared so the game stays movable
+            std::shared_ptr< audio_queue_t > _audio_queue = std::make_shared< audio_queue_t >() ;
+
+        private: // input
+
+            // pushed by on_device, applied at the start of a physics step
+            enum class input { move, level } ;
+            typedef input_queue< input > inputs_t ;
+            std::shared_ptr< inputs_t > _input = std::make_shared< inputs_t >() ;
+
+            // the last movement pushed. only used by on_device.
+            natus::math::vec2f_t _input_move ;
+
+            // pushed by logic, applied at the start of a physics step
+            enum class command { sheets } ;
+            typedef input_queue< command > commands_t ;
+            std::shared_ptr< commands_t > _commands = std::make_shared< commands_t >( "command" ) ;
 
         private: // score
 
@@ -215,154 +668,493 @@ namespace paddle_n_ball
 
         private:
 
-            bool_t _is_init = false ;
-            size_t _level_cur = 0 ;
+            size_t _level_first = 1 ;
             size_t _level_max = 4 ;
 
+        private: // level prefetch
+
+            // a level loaded and prepared off the game callbacks. It is never
+            // changed once published.
+            struct prepared_level
+            {
+                size_t no = 0 ;
+                level_t level ;
+                bricks_t bricks ;
+
+                // the version it was published with
+                size_t version = 0 ;
+
+                // the bricks sit on the level grid. Cell (x,y) is centered 
+                // at start + (x,-y) * pitch and grid holds the index of its
+                // brick or uint32_t(-1). 4 bytes a cell next to the packed 
+                // cells.
+                natus::math::vec2f_t start ;
+                natus::math::vec2f_t pitch ;
+                natus::math::vec2f_t half ;
+                natus::ntd::vector< uint32_t > grid ;
+            };
+            natus_typedef( prepared_level ) ;
+            typedef std::shared_ptr< prepared_level_t > prepared_level_ptr_t ;
+
+            // the level being played. A new level replaces it as a whole so 
+            // the callbacks never see a level that is still being prepared.
+            // Nothing is played until the first level is published.
+            typedef versioned_ptr< prepared_level_t const > current_level_t ;
+            std::shared_ptr< current_level_t > _level = std::make_shared< current_level_t >() ;
+
+            // the next level is prefetched while the current one is played.
+            // A prefetch only publishes if its generation is still the 
+            // current one so a level chosen by key press wins over any 
+            // prefetch that is still in flight.
+            struct prefetch
+            {
+                // guards all but ready which may be peeked at without it
+                std::mutex mtx ;
+                size_t gen = 0 ;
+                std::atomic< bool_t > ready { false } ;
+                prepared_level_ptr_t next ;
+
+                // stops the superseded prefetch
+                cancel_token_ptr_t token ;
+            };
+            natus_typedef( prefetch ) ;
+            std::shared_ptr< prefetch_t > _prefetch = std::make_shared< prefetch_t >() ;
+
+        private: // played level
+
+            // the simulation plays on its own copy of the bricks of the 
+            // published level. Only the physics step takes over a new level
+            // and touches the copy. Graphics reads the snapshot physics 
+            // publishes.
+            current_level_t::ptr_t _played ;
+            bricks_t _bricks ;
+
+            // the sheets the ids of the played entities refer to. Only 
+            // replaced by the physics step.
+            sheet_reload_t::sheets_ptr_t _sheets ;
+
+            // the animations advance in whole milliseconds of physics time
+            size_t _anim_us = 0 ;
+
+            // what logic needs of the played level. Written by physics only.
+            // The count is stored before the version, so logic reading the
+            // version first never pairs a level with the count of the last.
+            struct played_state
+            {
+                std::atomic< size_t > version { 0 } ;
+
+                // visible bricks
+                std::atomic< size_t > alive { 0 } ;
+            };
+            natus_typedef( played_state ) ;
+            std::shared_ptr< played_state_t > _played_state = std::make_shared< played_state_t >() ;
+
+        private: // graphics
+
+            struct sprite_item
+            {
+                natus::math::vec2f_t prev_pos ;
+                natus::math::vec2f_t pos ;
+                natus::math::vec2f_t scale ;
+                natus::math::vec4f_t rect ;
+                natus::math::vec2f_t pivot ;
+                natus::math::vec4f_t color ;
+            };
+            natus_typedef( sprite_item ) ;
+
+            // all graphics needs of one physics step. Graphics only reads 
+            // this so it never touches the simulation state.
+            struct render_snapshot
+            {
+                natus::ntd::vector< sprite_item_t > sprites ;
+
+                // drawn rotated
+                natus::ntd::vector< sprite_item_t > lives ;
+
+                bool_t has_ball = false ;
+                sprite_item_t ball ;
+
+                // the extra balls. drawn like the ball.
+                natus::ntd::vector< natus::math::vec2f_t > balls_pos ;
+                natus::ntd::vector< natus::math::vec2f_t > balls_prev_pos ;
+
+                natus::ntd::vector< bounding_box_2d_t > boxes ;
+                size_t score = 0 ;
+            };
+            natus_typedef( render_snapshot ) ;
+
+            // shared so the game stays movable
+            typedef triple_buffer< render_snapshot_t > snapshots_t ;
+            std::shared_ptr< snapshots_t > _snapshots = std::make_shared< snapshots_t >() ;
+
+            // the snapshot drawn this frame. only used by the graphics callbacks.
+            render_snapshot_t const * _drawn = nullptr ;
+
+        private: // level requests
+
+            // the level requested by key press. Only the newest request runs 
+            // to completion, a new request cancels the one in flight. A 
+            // request for the level that is already in flight is dropped.
+            struct level_request
+            {
+                std::mutex mtx ;
+                size_t no = 0 ;
+                cancel_token_ptr_t token ;
+            };
+            natus_typedef( level_request ) ;
+            std::shared_ptr< level_request_t > _level_request = std::make_shared< level_request_t >() ;
+
         public: 
 
-            size_t get_score( void_t ) const noexcept { return _score ; }
+            // the score of the snapshot drawn last
+            size_t get_drawn_score( void_t ) const noexcept { return _drawn != nullptr ? _drawn->score : 0 ; }
 
         public:
 
             struct init_data
             {
-                natus::gfx::sprite_sheets_res_t sheets ;
+                // published anew on every hot reload. Loaded once per use.
+                sheet_reload_t::current_sheets_ptr_t sheets ;
                 natus::io::database_res_t db ;
                 natus::audio::async_access_t audio ;
+                startup_trace_ptr_t trace ;
             };
             natus_typedef( init_data ) ;
             init_data _init_data ;
 
 
             //********************************************************************************
-            natus::concurrent::task_res_t load_and_prepare_level_task( size_t const level_no, natus::concurrent::task_res_t tin ) 
+            // a cancelled token stops the load at the next task boundary and 
+            // leaves out empty.
+            natus::concurrent::task_res_t load_and_prepare_level_task( size_t const level_no, 
+                prepared_level_ptr_t out, natus::concurrent::task_res_t tin, cancel_token_ptr_t token ) 
             {
-                auto const & sheets = *_init_data.sheets ;
-                if( sheets.size() == 0 ) return natus::concurrent::task_res_t() ;
+                // the tasks keep the sheets they started with
+                auto const sheets = _init_data.sheets->load() ;
+                if( sheets == nullptr || sheets->size() == 0 ) return natus::concurrent::task_res_t() ;
 
-                auto const & sheet = sheets[0] ;
-
-                natus::concurrent::task_res_t load_level = natus::concurrent::task_t([&, level_no]( natus::concurrent::task_res_t )
+                natus::concurrent::task_res_t load_level = natus::concurrent::task_t([&, level_no, out, token]( natus::concurrent::task_res_t )
                 {
-                    auto const res = _init_data.db->load( natus::io::location_t("layouts.level_"+std::to_string(level_no)+".txt"), true ).
+                    out->no = level_no ;
+                    if( token->is_cancelled() ) return ;
+
+                    this_t::level_t l ;
+                    bool_t loaded = false ;
+                    size_t bytes = 0 ;
+
+                    // only traced while starting up
+                    size_t const ph = _init_data.trace->begin( "level " + std::to_string( level_no ) + " load" ) ;
+
+                    // prefer the binary layout, fall back to the text layout
+                    _init_data.db->load( natus::io::location_t("layouts.level_"+std::to_string(level_no)+".bin"), true ).
                         wait_for_operation( [&]( char_cptr_t data_ptr, size_t const sib )
                     {
-                        natus::ntd::string_t const data( data_ptr, sib ) ;
-
-                        if( data.size() == 0 ) return ;
+                        loaded = this_t::level_t::from_binary( data_ptr, sib, l ) ;
+                        bytes = sib ;
+                    } ) ;
 
-                        size_t const p = data.find_first_of('\n') ;
-                        if( p == std::string::npos ) 
+                    if( !loaded && !token->is_cancelled() )
+                    {
+                        _init_data.db->load( natus::io::location_t("layouts.level_"+std::to_string(level_no)+".txt"), true ).
+                            wait_for_operation( [&]( char_cptr_t data_ptr, size_t const sib )
                         {
-                            natus::log::global_t::error("file requires \\n char.") ;
-                            return ;
-                        }
+                            loaded = this_t::level_t::from_text( data_ptr, sib, l ) ;
+                            bytes = sib ;
+                        } ) ;
+                    }
 
-                        auto const w = p - 1 ;
-                        auto h = 0 ;
+                    _init_data.trace->end( ph, bytes ) ;
 
-                        this_t::level_t l ;
-                        l.layout.reserve( data.size() ) ;
-                        for( size_t i=0; i<data.size(); ++i ) 
-                        {
-                            auto const & c = data[i] ;
-                            if( c == '\n' ) ++h ;
-                        }
-                        if( data[data.size()-1] != '\n' ||
-                            data[data.size()-2] != '\n' ) ++h ;
+                    if( token->is_cancelled() ) return ;
 
-                        for( size_t i=0; i<data.size(); ++i ) 
-                        {
-                            auto const & c = data[i] ;
-                            if( c == '\r' || c == '\n' ) 
-                            {
-                                continue ;
-                            }
-                            l.layout.emplace_back( size_t(c) ) ;
-                        }
-                        l.w = w ;
-                        l.h = h ;
-                        
-                        _level = std::move( l ) ;
-                        _bricks.resize( w * h ) ;
-                    } ) ;
-                    natus::log::global_t::error( !res, "can not find level file for " + std::to_string(level_no) ) ;
+                    natus::log::global_t::error( !loaded, "can not find level file for " + std::to_string(level_no) ) ;
+                    if( !loaded ) return ;
+
+                    out->level = std::move( l ) ;
                 }) ;
 
-                natus::concurrent::task_res_t prepare_level = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
+                natus::concurrent::task_res_t prepare_level = natus::concurrent::task_t( [&, sheets, out, token]( natus::concurrent::task_res_t )
                 {
+                    if( token->is_cancelled() ) return ;
+
+                    auto const & lvl = out->level ;
+
                     natus::ntd::vector< natus::ntd::string_t > names = { "brick" } ;
                     natus::ntd::vector< natus::ntd::string_t > animations = { "idle" } ;
 
                     natus::math::vec2f_t dims( 1.0f ) ;
 
-                    auto const brs = brick_t::load_from( sheet, names, animations ) ;
+                    brick_t proto ;
+
+                    auto const brs = brick_t::load_from( (*sheets)[0], names, animations ) ;
                     if( brs.size() > 0 )
                     {
-                        for( size_t i=0; i<_bricks.size() ; ++i )
-                            _bricks[i] = brs[0] ;
+                        proto = brs[0] ;
 
-                        auto const s = sheets[0].determine_sprite( brs[0].obj_id, brs[0].ani_id, brs[0].anim_time ) ;
+                        auto const s = (*sheets)[0].determine_sprite( brs[0].obj_id, brs[0].ani_id, brs[0].anim_time ) ;
                         dims = (s.rect.zw()-s.rect.xy()) * natus::math::vec2f_t( brs[0].scale ) ;
                     }
 
-                    auto const field = natus::math::vec2f_t( float_t(_level.w), float_t( _level.h ) ) ;
+                    auto const field = natus::math::vec2f_t( float_t(lvl.w), float_t( lvl.h ) ) ;
                     auto const req_off = natus::math::vec2f_t( 10.0f, 5.0f ) ;
                     auto const req_dims =  field * dims + req_off * (field-natus::math::vec2f_t(1.0f)) ;
 
                     natus::math::vec2f_t const start = req_dims * natus::math::vec2f_t( -0.5f, 0.0f ) + natus::math::vec2f_t( 0.0, 250.0f ) ;
 
-                    // init positions
+                    // create bricks for occupied cells only
                     {
-                        for( size_t i=0; i<_level.layout.size(); ++i )
+                        bricks_t bricks ;
+                        bricks.reserve( lvl.count_occupied() ) ;
+
+                        lvl.for_each_occupied( [&]( size_t const i, size_t const v )
                         {
-                            size_t const y = i / _level.w ;
-                            size_t const x = i % _level.w ;
+                            size_t const y = i / lvl.w ;
+                            size_t const x = i % lvl.w ;
+
+                            brick_t b = proto ;
+                            b.comp.cell = i ;
+                            b.comp.kind = v ;
+                            b.pos = start + natus::math::vec2f_t( float_t(x), -float_t(y) ) * (dims+req_off) ;
+                            bricks.emplace_back( std::move( b ) ) ;
+                        } ) ;
 
-                            auto & intr = _bricks[i] ;
-                            intr.comp.is_visible = _level.layout[i] != '.' ;
-                            intr.pos = start + natus::math::vec2f_t( float_t(x), -float_t(y) ) * (dims+req_off) ;
-                        }
+                        out->bricks = std::move( bricks ) ;
                     }
+
+                    out->start = start ;
+                    out->pitch = dims + req_off ;
+                    out->half = dims * natus::math::vec2f_t( 0.5f ) ;
+                    out->grid.clear() ;
+                    out->grid.resize( lvl.w * lvl.h, uint32_t( -1 ) ) ;
+                    for( size_t i=0; i<out->bricks.size(); ++i ) out->grid[ out->bricks[i].comp.cell ] = uint32_t( i ) ;
                 }) ;
 
                 return tin->then( load_level )->then( prepare_level ) ;
             }
 
+            //********************************************************************************
+            // loads the level in the background and makes it the current level once prepared.
+            natus::concurrent::task_res_t load_level_task( size_t const level_no, cancel_token_ptr_t token ) noexcept
+            {
+                auto out = std::make_shared< prepared_level_t >() ;
+                size_t const version = _level->issue() ;
+
+                auto req = _level_request ;
+
+                natus::concurrent::task_res_t root = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t ){}) ;
+                natus::concurrent::task_res_t finish = natus::concurrent::task_t([&, out, version, req, token]( natus::concurrent::task_res_t )
+                {
+                    {
+                        std::lock_guard< std::mutex > lk( req->mtx ) ;
+                        if( req->token == token ) req->token.reset() ;
+                    }
+
+                    if( token->is_cancelled() ) return ;
+                    if( !this_t::make_current( out, version ) ) return ;
+                    this_t::prefetch_next_level() ;
+                } ) ;
+
+                this_t::load_and_prepare_level_task( level_no, out, root, token )->then( finish ) ;
+
+                return root ;
+            }
+
+            //********************************************************************************
+            // coalesces level requests. The newest request cancels the one in
+            // flight unless both are for the same level.
+            void_t request_level( size_t const level_no ) noexcept
+            {
+                auto token = std::make_shared< cancel_token_t >() ;
+
+                {
+                    std::lock_guard< std::mutex > lk( _level_request->mtx ) ;
+
+                    auto & req = *_level_request ;
+                    if( req.token != nullptr )
+                    {
+                        if( req.no == level_no ) return ;
+                        req.token->cancel() ;
+                    }
+
+                    req.no = level_no ;
+                    req.token = token ;
+                }
+
+                natus::concurrent::global_t::schedule( this_t::load_level_task( level_no, token ), 
+                    natus::concurrent::schedule_type::loose ) ;
+            }
+
+            //********************************************************************************
+            // publishes p as the level being played. Returns false if a newer
+            // level was published meanwhile.
+            bool_t make_current( prepared_level_ptr_t p, size_t const version ) noexcept
+            {
+                if( p->level.num_cells() == 0 ) return false ;
+
+                p->version = version ;
+                return _level->publish( p, version ) ;
+            }
+
+            //********************************************************************************
+            // starts loading the level after the current one or after the 
+            // given level. Any older prefetch is superseded.
+            void_t prefetch_next_level( size_t const after = size_t( -1 ) ) noexcept
+            {
+                auto pf = _prefetch ;
+
+                auto const cur = _level->load() ;
+                size_t const level_cur = after != size_t( -1 ) ? after : cur != nullptr ? cur->no : _level_first ;
+
+                // the new generation, the reset and the token swap are one 
+                // step so a superseded prefetch can not publish in between
+                auto token = std::make_shared< cancel_token_t >() ;
+                size_t gen = 0 ;
+                {
+                    std::lock_guard< std::mutex > lk( pf->mtx ) ;
+                    if( pf->token != nullptr ) pf->token->cancel() ;
+                    pf->token = token ;
+
+                    gen = ++pf->gen ;
+                    pf->ready = false ;
+                    pf->next = nullptr ;
+                }
+
+                auto out = std::make_shared< prepared_level_t >() ;
+
+                natus::concurrent::task_res_t root = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t ){}) ;
+                natus::concurrent::task_res_t publish = natus::concurrent::task_t([pf, gen, out]( natus::concurrent::task_res_t )
+                {
+                    std::lock_guard< std::mutex > lk( pf->mtx ) ;
+                    if( pf->gen != gen ) return ;
+
+                    pf->next = out ;
+                    pf->ready = true ;
+                } ) ;
+
+                this_t::load_and_prepare_level_task( (level_cur % _level_max) + 1, out, root, token )->then( publish ) ;
+                natus::concurrent::global_t::schedule( root, natus::concurrent::schedule_type::loose ) ;
+            }
+
+            //********************************************************************************
+            // swaps in the prefetched level if it is ready. Returns false if 
+            // the prefetch is still in flight.
+            bool_t swap_in_next_level( void_t ) noexcept
+            {
+                // a cheap peek. It is checked again under the lock.
+                if( !_prefetch->ready ) return false ;
+
+                prepared_level_ptr_t next ;
+                {
+                    std::lock_guard< std::mutex > lk( _prefetch->mtx ) ;
+                    if( !_prefetch->ready ) return false ;
+
+                    next = std::move( _prefetch->next ) ;
+                    _prefetch->ready = false ;
+                }
+
+                if( this_t::make_current( next, _level->issue() ) ) 
+                {
+                    this_t::prefetch_next_level() ;
+                    return true ;
+                }
+
+                // an empty or failed level is skipped. A prefetch is started
+                // on every path so the game never waits for a level that 
+                // does not come.
+                this_t::prefetch_next_level( next->level.num_cells() == 0 ? next->no : size_t( -1 ) ) ;
+
+                return false ;
+            }
+
+            //********************************************************************************
+            // converts all text layouts into binary layouts next to them.
+            natus::concurrent::task_res_t convert_layouts_task( bool_t const rle ) noexcept
+            {
+                return natus::concurrent::task_t( [&, rle]( natus::concurrent::task_res_t )
+                {
+                    for( size_t i=1; i<=_level_max; ++i )
+                    {
+                        natus::ntd::string_t const name = "level_" + std::to_string( i ) ;
+
+                        this_t::level_t l ;
+                        bool_t loaded = false ;
+
+                        _init_data.db->load( natus::io::location_t( "layouts." + name + ".txt" ), true ).
+                            wait_for_operation( [&]( char_cptr_t data_ptr, size_t const sib )
+                        {
+                            loaded = this_t::level_t::from_text( data_ptr, sib, l ) ;
+                        } ) ;
+
+                        if( !loaded ) 
+                        {
+                            natus::log::global_t::error( "[convert_layouts] : can not load " + name ) ;
+                            continue ;
+                        }
+
+                        auto const data = l.to_binary( rle ) ;
+
+                        natus::ntd::string_t const path = natus::ntd::string_t( DATAPATH ) + 
+                            "/working/layouts/" + name + ".bin" ;
+
+                        std::ofstream out( path, std::ios::binary | std::ios::trunc ) ;
+                        out.write( data.data(), data.size() ) ;
+
+                        if( !out.good() )
+                        {
+                            natus::log::global_t::error( "[convert_layouts] : can not write " + path ) ;
+                            continue ;
+                        }
+
+                        natus::log::global_t::status( "[convert_layouts] : " + name + " " + 
+                            std::to_string( l.w ) + "x" + std::to_string( l.h ) + " @ " + std::to_string( l.bits ) + 
+                            " bits -> " + std::to_string( data.size() ) + " bytes" ) ;
+                    }
+                } ) ;
+            }
+
             //********************************************************************************
             natus::concurrent::task_res_t on_init( init_data_rref_t d ) noexcept
             {
                 _init_data = std::move( d ) ;
 
-                auto const & sheets = *_init_data.sheets ;
-                if( sheets.size() == 0 ) return natus::concurrent::task_res_t() ;
-                
-                auto const & sheet = sheets[0] ;
+                // the tasks keep the sheets they started with
+                auto const sheets = _init_data.sheets->load() ;
+                if( sheets == nullptr || sheets->size() == 0 ) return natus::concurrent::task_res_t() ;
+
+                _sheets = sheets ;
 
                 natus::concurrent::task_res_t root = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
                 {
                 }) ;
 
-                natus::concurrent::task_res_t finish = natus::concurrent::task_t([&]( natus::concurrent::task_res_t )
+                auto first = std::make_shared< prepared_level_t >() ;
+                size_t const version = _level->issue() ;
+
+                // closed when all init tasks are done
+                size_t const ph = _init_data.trace->begin( "game init" ) ;
+
+                natus::concurrent::task_res_t finish = natus::concurrent::task_t([&, first, version, ph]( natus::concurrent::task_res_t )
                 {
-                    _is_init = true ;
+                    bool_t const published = this_t::make_current( first, version ) ;
+                    _init_data.trace->end( ph ) ;
+                    if( published ) this_t::prefetch_next_level() ;
                 } ) ;
 
-                this_t::load_and_prepare_level_task( _level_cur, root )->then( finish ) ;
+                this_t::load_and_prepare_level_task( _level_first, first, root, 
+                    std::make_shared< cancel_token_t >() )->then( finish ) ;
 
-                natus::concurrent::task_res_t prepare_player = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
+                natus::concurrent::task_res_t prepare_player = natus::concurrent::task_t( [&, sheets]( natus::concurrent::task_res_t )
                 {
                     natus::ntd::vector< natus::ntd::string_t > names = { "paddle" } ;
                     natus::ntd::vector< natus::ntd::string_t > animations = { "move" } ;
                     natus::math::vec2f_t dims( 1.0f ) ;
 
-                    auto const ents = paddle_t::load_from( sheet, names, animations ) ;
+                    auto const ents = paddle_t::load_from( (*sheets)[0], names, animations ) ;
                     if( ents.size() > 0 )
                     {
                         _paddle = ents[0] ;
 
-                        auto const s = sheets[0].determine_sprite( ents[0].obj_id, ents[0].ani_id, ents[0].anim_time ) ;
+                        auto const s = (*sheets)[0].determine_sprite( ents[0].obj_id, ents[0].ani_id, ents[0].anim_time ) ;
                         dims = (s.rect.zw()-s.rect.xy()) * natus::math::vec2f_t( ents[0].scale ) ;
                     }
 
@@ -370,22 +1162,23 @@ namespace paddle_n_ball
                     {
                         _paddle.scale = 500.0f ;
                         _paddle.pos = natus::math::vec2f_t( -400.0f, -250.0f ) ;
+                        _paddle.prev_pos = _paddle.pos ;
                     }
                 } ) ;
                 root->then( prepare_player )->then( finish ) ;
 
-                natus::concurrent::task_res_t prepare_ball = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
+                natus::concurrent::task_res_t prepare_ball = natus::concurrent::task_t( [&, sheets]( natus::concurrent::task_res_t )
                 {
                     natus::ntd::vector< natus::ntd::string_t > names = { "ball" } ;
                     natus::ntd::vector< natus::ntd::string_t > animations = { "move" } ;
                     natus::math::vec2f_t dims( 1.0f ) ;
 
-                    auto const ents = ball_t::load_from( sheet, names, animations ) ;
+                    auto const ents = ball_t::load_from( (*sheets)[0], names, animations ) ;
                     if( ents.size() > 0 )
                     {
                         _ball = ents[0] ;
 
-                        auto const s = sheets[0].determine_sprite( ents[0].obj_id, ents[0].ani_id, ents[0].anim_time ) ;
+                        auto const s = (*sheets)[0].determine_sprite( ents[0].obj_id, ents[0].ani_id, ents[0].anim_time ) ;
                         dims = (s.rect.zw()-s.rect.xy()) * natus::math::vec2f_t( ents[0].scale ) ;
                     }
 
@@ -393,6 +1186,7 @@ namespace paddle_n_ball
                     {
                         _ball.scale = 150.0f ;
                         _ball.pos = natus::math::vec2f_t( 0.0f, -200.0f ) ;
+                        _ball.prev_pos = _ball.pos ;
                         _ball.comp.adv = natus::math::vec2f_t( 1.0f, 1.0f ) ;
                     }
                 } ) ;
@@ -400,6 +1194,8 @@ namespace paddle_n_ball
 
                 natus::concurrent::task_res_t load_audio = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
                 {
+                    size_t const ph = _init_data.trace->begin( "audio" ) ;
+
                     auto b1 = natus::audio::buffer_object_res_t( natus::audio::buffer_object_t( "audio.paddle.hit" ) ) ;
                     auto b2 = natus::audio::buffer_object_res_t( natus::audio::buffer_object_t( "audio.brick.hit" ) ) ;
 
@@ -426,9 +1222,16 @@ namespace paddle_n_ball
                     _paddle.comp.hit_sound = b1 ;
                     _ball.comp.hit_sound = b2 ;
 
+                    // max voices, priority, duration
+                    _paddle.comp.hit_sid = _audio_queue->add_buffer( b1, { 2, 1, std::chrono::milliseconds( 150 ) } ) ;
+                    _ball.comp.hit_sid = _audio_queue->add_buffer( b2, { 4, 0, std::chrono::milliseconds( 150 ) } ) ;
+
                     _init_data.audio.configure( _paddle.comp.hit_sound ) ;
                     _init_data.audio.configure( _ball.comp.hit_sound  ) ;
 
+                    _init_data.trace->end( ph, startup_trace_t::file_size( "audio/bik.wav" ) + 
+                        startup_trace_t::file_size( "audio/bok.wav" ) ) ;
+
                 } ) ;
                 root->then( load_audio )->then( finish ) ;
 
@@ -438,28 +1241,35 @@ namespace paddle_n_ball
             //********************************************************************************
             void_t on_update( void_t ) noexcept
             {
-                if( !_is_init ) return ;
+                if( _level->load() == nullptr ) return ;
                 //auto const dt = std::chrono::milliseconds( milli_dt ) ;
             }
 
             //********************************************************************************
             void_t on_device( natus::device::ascii_device_res_t keyboard, natus::device::game_device_res_t dev ) noexcept
             {
-                if( !_is_init ) return ;
+                if( _level->load() == nullptr ) return ;
 
                 // move paddle
                 {
                     using ctrl_t = natus::device::layouts::game_controller_t ;
                     ctrl_t ctrl( dev ) ;
 
+                    // only changes are pushed
+                    auto const move = [&]( natus::math::vec2f_t const & v )
+                    {
+                        if( v.x() == _input_move.x() && v.y() == _input_move.y() ) return ;
+                        if( _input->push( input::move, v ) ) _input_move = v ;
+                    } ;
+
                     natus::math::vec2f_t value ;
                     if( ctrl.is( ctrl_t::directional::movement, natus::device::components::stick_state::tilting, value ) )
                     {
-                        _paddle.comp.adv = value ;
+                        move( value ) ;
                     }
                     if( ctrl.is( ctrl_t::directional::movement, natus::device::components::stick_state::untilted, value ) )
                     {
-                        _paddle.comp.adv = natus::math::vec2f_t() ;
+                        move( natus::math::vec2f_t() ) ;
                     }
                 }
 
@@ -471,267 +1281,618 @@ namespace paddle_n_ball
                     if( ascii.get_state( natus::device::layouts::ascii_keyboard_t::ascii_key::k_1 ) ==
                         natus::device::components::key_state::released )
                     {
-                        _is_init = false ;
                         level = 1 ;
                     }
                     else if( ascii.get_state( natus::device::layouts::ascii_keyboard_t::ascii_key::k_2 ) ==
                         natus::device::components::key_state::released )
                     {
-                        _is_init = false ;
                         level = 2 ;
                     }
                     else if( ascii.get_state( natus::device::layouts::ascii_keyboard_t::ascii_key::k_3 ) ==
                         natus::device::components::key_state::released )
                     {
-                        _is_init = false ;
                         level = 3 ;
                     }
                     else if( ascii.get_state( natus::device::layouts::ascii_keyboard_t::ascii_key::k_4 ) ==
                         natus::device::components::key_state::released )
                     {
-                        _is_init = false ;
                         level = 4 ;
                     }
 
-                    if( level != size_t(-1) )
+                    if( level != size_t(-1) ) _input->push( input::level, natus::math::vec2f_t( float_t( level ), 0.0f ) ) ;
+                }
+                
+            }
+
+            //********************************************************************************
+            // takes over a newly published level. Returns the level being 
+            // played or nullptr if none was published yet.
+            prepared_level_t const * sync_level( void_t ) noexcept
+            {
+                auto cur = _level->load() ;
+                if( cur != _played )
+                {
+                    _bricks = cur != nullptr ? cur->bricks : bricks_t() ;
+                    _played_state->alive = _bricks.size() ;
+                    _played_state->version = cur != nullptr ? cur->version : 0 ;
+                    _played = std::move( cur ) ;
+                }
+                return _played.get() ;
+            }
+
+            //********************************************************************************
+            // applies the input pushed since the last physics step
+            void_t apply_input( void_t ) noexcept
+            {
+                _input->consume( [&]( inputs_t::event_cref_t e )
+                {
+                    switch( e.what )
+                    {
+                    case input::move: 
+                        _paddle.comp.adv = e.value ;
+                        break ;
+
+                    case input::level: 
+                        this_t::request_level( size_t( e.value.x() ) ) ;
+                        break ;
+                    }
+                } ) ;
+            }
+
+            //********************************************************************************
+            // applies the commands pushed since the last physics step
+            void_t apply_commands( void_t ) noexcept
+            {
+                _commands->consume( [&]( commands_t::event_cref_t e )
+                {
+                    switch( e.what )
+                    {
+                    case command::sheets: 
+                        this_t::take_over_sheets() ;
+                        break ;
+                    }
+                } ) ;
+            }
+
+            //********************************************************************************
+            // the simulation state is physics only. Logic only swaps in the 
+            // next level.
+            void_t on_logic( void_t ) noexcept 
+            {
+                // a level physics did not take over yet has no count
+                auto const & ps = *_played_state ;
+                size_t const version = ps.version ;
+                if( version == 0 || version != _level->version() ) return ;
+
+                // test new level
+                {
+                    // the next level is prefetched. If it is still in flight,
+                    // the empty level is kept until it arrives.
+                    if( ps.alive == 0 )
+                    {
+                        this_t::swap_in_next_level() ;
+                    }
+
+                }
+            }
+
+            //********************************************************************************
+            // one fixed physics step
+            void_t on_physics( size_t const micro_dt ) noexcept
+            {
+                auto const cur = this_t::sync_level() ;
+                if( cur == nullptr ) return ;
+
+                this_t::apply_commands() ;
+                this_t::apply_input() ;
+
+                if( _paddle.comp.num_lifes == 0 )
+                {
+                    _paddle.comp.num_lifes = 3 ;
+                    _score = 0 ;
+                }
+
+                // the sprites are animated before they are collided with
+                this_t::animate( micro_dt ) ;
+
+                float_t const dt = (float_t(micro_dt) / 1000000.0f) ;
+
+                // interpolation starts from here
+                _paddle.prev_pos = _paddle.pos ;
+                _ball.prev_pos = _ball.pos ;
+
+                // player
+                {
+                    _paddle.pos += natus::math::vec2f_t( 600.0f, 0.0f ) * 
+                        natus::math::vec2f_t( _paddle.comp.adv.x() * dt ) ;
+
+                    float_t const thres = 345.0f ;
+                    if( _paddle.pos.x() > thres || _paddle.pos.x() < -thres )
                     {
-                        _level_cur = level ;
-                        natus::concurrent::task_res_t root = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t ){}) ;
-                        natus::concurrent::task_res_t finish = natus::concurrent::task_t([&]( natus::concurrent::task_res_t ){ _is_init = true ; } ) ;
-                        this_t::load_and_prepare_level_task( level, root )->then( finish ) ;
-                        natus::concurrent::global_t::schedule( root, natus::concurrent::schedule_type::loose ) ;
+                        _paddle.pos = natus::math::vec2f_t( thres * natus::math::fn<float_t>::sign(_paddle.pos.x()), 
+                            _paddle.pos.y() ) ;
                     }
                 }
-                
+
+                this_t::move_ball( *cur, dt ) ;
+                this_t::move_balls( *cur, dt ) ;
+
+                this_t::publish_snapshot() ;
+            }
+
+            //********************************************************************************
+            // advances the paddle, ball and brick animations
+            void_t animate( size_t const micro_dt ) noexcept
+            {
+                _anim_us += micro_dt ;
+                size_t const milli_dt = _anim_us / 1000 ;
+                _anim_us -= milli_dt * 1000 ;
+
+                size_t const sheet = 0 ;
+                if( _sheets == nullptr || _sheets->size() <= sheet ) return ;
+
+                auto const & s = (*_sheets)[sheet] ;
+
+                _paddle.animate( s, milli_dt ) ;
+                _ball.animate( s, milli_dt ) ;
+                for( auto & b : _bricks ) b.animate( s, milli_dt ) ;
+            }
+
+            //********************************************************************************
+            // the time in [0,t) a point moving from p by d enters the box 
+            // [mn,mx] and the normal of the face it enters through. Returns 
+            // false if it misses, moves away or starts inside.
+            static bool_t sweep_box( natus::math::vec2f_t const & p, natus::math::vec2f_t const & d, 
+                natus::math::vec2f_t const & mn, natus::math::vec2f_t const & mx, 
+                float_t & t, natus::math::vec2f_t & n ) noexcept
+            {
+                float_t t_enter = -std::numeric_limits< float_t >::max() ;
+                float_t t_leave = std::numeric_limits< float_t >::max() ;
+                natus::math::vec2f_t n_enter ;
+
+                auto const slab = [&]( float_t const pi, float_t const di, float_t const lo, float_t const hi, 
+                    natus::math::vec2f_t const & axis )
+                {
+                    if( di == 0.0f ) 
+                    {
+                        if( pi < lo || pi > hi ) t_leave = -1.0f ;
+                        return ;
+                    }
+
+                    float_t const t0 = (lo - pi) / di ;
+                    float_t const t1 = (hi - pi) / di ;
+
+                    if( std::min( t0, t1 ) > t_enter )
+                    {
+                        t_enter = std::min( t0, t1 ) ;
+                        n_enter = axis * natus::math::vec2f_t( di > 0.0f ? -1.0f : 1.0f ) ;
+                    }
+                    t_leave = std::min( t_leave, std::max( t0, t1 ) ) ;
+                } ;
+
+                slab( p.x(), d.x(), mn.x(), mx.x(), natus::math::vec2f_t( 1.0f, 0.0f ) ) ;
+                slab( p.y(), d.y(), mn.y(), mx.y(), natus::math::vec2f_t( 0.0f, 1.0f ) ) ;
+
+                if( t_enter < 0.0f || t_enter > t_leave || t_enter >= t ) return false ;
+
+                t = t_enter ;
+                n = n_enter ;
+
+                return true ;
             }
 
             //********************************************************************************
-            void_t on_logic( natus::gfx::sprite_sheets_cref_t sheets, size_t const milli_dt ) noexcept 
+            // moves a ball at pos in direction adv over dt. The ball is swept
+            // against the walls, the paddle and the bricks and bounces off the
+            // earliest hit. The rest of the step goes on from there, so the 
+            // ball may bounce more than once per step and does not tunnel at 
+            // any speed or physics rate. The paddle already moved this step, so
+            // it is swept with the motion relative to it and a ball that 
+            // starts inside it is pushed out first. Only the ball is changed,
+            // the hits are returned, so balls can be swept in parallel.
+            ball_hits_t sweep_ball( prepared_level_cref_t lvl, natus::math::vec2f_t & pos, natus::math::vec2f_t & adv, 
+                natus::math::vec2f_t const & half, float_t const dt ) const noexcept
             {
-                if( !_is_init ) return ;
+                ball_hits_t ret ;
 
-                size_t const sheet = 0 ;
+                auto const & bricks = _bricks ;
 
-                // paddle
-                {
-                    paddle_ref_t entity = _paddle ;
+                enum class hit { none, wall, bottom, paddle, brick } ;
 
-                    if( entity.ani_id != size_t(-1) )
-                    {
-                        entity.cur_sprite = sheets[sheet].determine_sprite( entity.obj_id, entity.ani_id, entity.anim_time ) ;
-                        entity.anim_time += milli_dt ;
-                        entity.anim_time = entity.anim_time % entity.max_ani_time ;
-                    }
+                natus::math::vec2f_t const thres = natus::math::vec2f_t( 400.0f, 300.0f ) ;
+
+                // the paddle box grown by the ball and the paddle motion of this step
+                natus::math::vec2f_t const pad_ext = _paddle.get_aabb().get_max() - _paddle.pos + half ;
+                natus::math::vec2f_t const pad_d = _paddle.pos - _paddle.prev_pos ;
+
+                // inside the paddle where the step starts. the ball leaves 
+                // through the closest face.
+                {
+                    natus::math::vec2f_t const rel = pos - _paddle.prev_pos ;
+                    float_t const dx = pad_ext.x() - std::abs( rel.x() ) ;
+                    float_t const dy = pad_ext.y() - std::abs( rel.y() ) ;
 
-                    if( _paddle.comp.num_lifes == 0 )
+                    if( dx > 0.0f && dy > 0.0f )
                     {
-                        _paddle.comp.num_lifes = 3 ;
-                        _score = 0 ;
+                        if( dx < dy )
+                        {
+                            float_t const sx = rel.x() < 0.0f ? -1.0f : 1.0f ;
+                            pos.x( _paddle.prev_pos.x() + pad_ext.x() * sx ) ;
+                            adv.x( std::abs( adv.x() ) * sx ) ;
+                        }
+                        else
+                        {
+                            float_t const sy = rel.y() < 0.0f ? -1.0f : 1.0f ;
+                            pos.y( _paddle.prev_pos.y() + pad_ext.y() * sy ) ;
+                            adv.y( std::abs( adv.y() ) * sy ) ;
+                        }
+                        ret.paddle = true ;
                     }
                 }
 
-                // ball
+                float_t rest = 1.0f ;
+                for( size_t bounce=0; bounce<MAX_BOUNCES && rest > 0.0f; ++bounce )
                 {
-                    natus::math::vec2f_t const thres = natus::math::vec2f_t( 400.0f, 300.0f ) ;
+                    natus::math::vec2f_t const d = natus::math::vec2f_t( 500.0f ) * 
+                        natus::math::vec2f_t( adv * dt * rest ) ;
+
+                    float_t t = 1.0f ;
+                    natus::math::vec2f_t n ;
+                    hit what = hit::none ;
+                    size_t which = 0 ;
+
+                    // the ball center stays within thres
+                    auto const wall = [&]( float_t const pi, float_t const di, float_t const lim, 
+                        natus::math::vec2f_t const & nrm, hit const h )
+                    {
+                        bool_t const reaches = lim > 0.0f ? 
+                            di > 0.0f && pi + di > lim : di < 0.0f && pi + di < lim ;
+                        if( !reaches ) return ;
 
-                    ball_ref_t entity = _ball ;
+                        float_t const tt = std::max( (lim - pi) / di, 0.0f ) ;
+                        if( tt >= t ) return ;
 
-                    if( entity.ani_id != size_t(-1) )
+                        t = tt ;
+                        n = nrm ;
+                        what = h ;
+                    } ;
+
+                    wall( pos.x(), d.x(), +thres.x(), natus::math::vec2f_t( -1.0f, 0.0f ), hit::wall ) ;
+                    wall( pos.x(), d.x(), -thres.x(), natus::math::vec2f_t( +1.0f, 0.0f ), hit::wall ) ;
+                    wall( pos.y(), d.y(), +thres.y(), natus::math::vec2f_t( 0.0f, -1.0f ), hit::wall ) ;
+                    wall( pos.y(), d.y(), -thres.y(), natus::math::vec2f_t( 0.0f, +1.0f ), hit::bottom ) ;
+
+                    // the boxes are grown by the ball so the ball is a point. The 
+                    // paddle is swept from where it is when this part starts.
                     {
-                        entity.cur_sprite = sheets[sheet].determine_sprite( entity.obj_id, entity.ani_id, entity.anim_time ) ;
-                        entity.anim_time += milli_dt ;
-                        entity.anim_time = entity.anim_time % entity.max_ani_time ;
+                        natus::math::vec2f_t const pad = _paddle.prev_pos + pad_d * natus::math::vec2f_t( 1.0f - rest ) ;
+                        natus::math::vec2f_t const rel = d - pad_d * natus::math::vec2f_t( rest ) ;
+                        if( this_t::sweep_box( pos, rel, pad - pad_ext, pad + pad_ext, t, n ) ) 
+                            what = hit::paddle ;
                     }
-                }
 
-                // bricks
-                {
-                    for( size_t y=0; y<_level.h; ++y )
+                    // only the grid cells within the swept bounds
+                    if( lvl.level.w > 0 && lvl.level.h > 0 )
                     {
-                        for( size_t x=0; x<_level.w; ++x )
+                        natus::math::vec2f_t const ext = lvl.half + half ;
+                        natus::math::vec2f_t const lo = natus::math::vec2f_t( 
+                            std::min( pos.x(), pos.x() + d.x() ), std::min( pos.y(), pos.y() + d.y() ) ) - ext ;
+                        natus::math::vec2f_t const hi = natus::math::vec2f_t( 
+                            std::max( pos.x(), pos.x() + d.x() ), std::max( pos.y(), pos.y() + d.y() ) ) + ext ;
+
+                        // columns grow with x, rows grow with -y
+                        auto const cell = [&]( float_t const v, size_t const n_ )
+                        {
+                            return size_t( std::min( std::max( v, 0.0f ), float_t( n_ - 1 ) ) ) ;
+                        } ;
+
+                        size_t const x0 = cell( std::floor( (lo.x() - lvl.start.x()) / lvl.pitch.x() ), lvl.level.w ) ;
+                        size_t const x1 = cell( std::ceil( (hi.x() - lvl.start.x()) / lvl.pitch.x() ), lvl.level.w ) ;
+                        size_t const y0 = cell( std::floor( (lvl.start.y() - hi.y()) / lvl.pitch.y() ), lvl.level.h ) ;
+                        size_t const y1 = cell( std::ceil( (lvl.start.y() - lo.y()) / lvl.pitch.y() ), lvl.level.h ) ;
+
+                        for( size_t y=y0; y<=y1; ++y )
                         {
-                            size_t const idx = y * _level.w + x ;
-                            auto & intr = _bricks[ idx ] ;
+                            for( size_t x=x0; x<=x1; ++x )
+                            {
+                                uint32_t const i = lvl.grid[ y * lvl.level.w + x ] ;
+                                if( i == uint32_t( -1 ) || !bricks[i].comp.is_visible ) continue ;
 
-                            intr.cur_sprite = sheets[sheet].determine_sprite( intr.obj_id, intr.ani_id, intr.anim_time ) ;
-                            intr.anim_time += milli_dt ;
-                            intr.anim_time = intr.anim_time % intr.max_ani_time ;
+                                // already hit this step
+                                auto const hit_end = ret.bricks.begin() + ret.num_bricks ;
+                                if( std::find( ret.bricks.begin(), hit_end, i ) != hit_end ) continue ;
+
+                                auto const & b = bricks[i] ;
+                                if( this_t::sweep_box( pos, d, b.pos - ext, b.pos + ext, t, n ) ) 
+                                {
+                                    what = hit::brick ;
+                                    which = i ;
+                                }
+                            }
                         }
                     }
-                }
 
-                // test new level
-                {
-                    size_t elems = _bricks.size() ;
-                    for( auto const & b : _bricks ) if( !b.comp.is_visible ) --elems ;
+                    pos += d * natus::math::vec2f_t( t ) ;
+                    rest *= 1.0f - t ;
+
+                    natus::math::vec2f_t const flip = n.x() != 0.0f ? 
+                        natus::math::vec2f_t( -1.0f, 1.0f ) : natus::math::vec2f_t( 1.0f, -1.0f ) ;
+
+                    switch( what )
+                    {
+                    case hit::none: 
+                        return ret ;
 
-                    if( elems == 0 )
+                    case hit::wall: 
+                        adv = adv * flip ;
+                        break ;
+
+                    case hit::bottom:
+                        ret.bottom = true ;
+                        return ret ;
+
+                    case hit::paddle:
                     {
-                        _is_init = false ;
-                        natus::concurrent::task_res_t root = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t ){}) ;
-                        natus::concurrent::task_res_t finish = natus::concurrent::task_t([&]( natus::concurrent::task_res_t )
+                        // away from the paddle even if it catches up with the ball
+                        if( n.x() != 0.0f ) adv.x( std::abs( adv.x() ) * n.x() ) ;
+                        else adv.y( std::abs( adv.y() ) * n.y() ) ;
+
+                        // the paddle at the time of the hit
+                        natus::math::vec2f_t const pad = _paddle.prev_pos + pad_d * natus::math::vec2f_t( 1.0f - rest ) ;
+
+                        // hits on the top get steered by the paddle close to the edges
+                        if( n.y() > 0.0f )
                         {
-                            _is_init = true ;
-                        } ) ;
+                            float_t const thres_steer = 100.0f ;
+                            float_t const w = (_paddle.get_aabb().get_max() - _paddle.pos).x() ;
+                            float_t const dist_r = (pos - pad).x() - w ;
+                            float_t const dist_l = -(pos - pad).x() - w ;
+
+                            if( std::abs( dist_r ) < thres_steer )
+                            {
+                                auto const f = std::min( std::abs( dist_r ), thres_steer ) / thres_steer ;
+                                adv.x( _paddle.comp.adv.x() * (1.0f - f) ) ;
+                            }
+                            else if( std::abs( dist_l ) < thres_steer )
+                            {
+                                auto const f = std::min( std::abs( dist_l ), thres_steer ) / thres_steer ;
+                                adv.x( _paddle.comp.adv.x() * (1.0f - f) ) ;
+                            }
+                        }
 
-                        this_t::load_and_prepare_level_task( ((++_level_cur)%_level_max)+1, root )->then( finish ) ;
-                        natus::concurrent::global_t::schedule( root, natus::concurrent::schedule_type::loose ) ;
+                        ret.paddle = true ;
+                        break ;
                     }
 
+                    case hit::brick:
+                        adv = adv * flip ;
+                        ret.bricks[ ret.num_bricks++ ] = which ;
+                        break ;
+                    }
                 }
+
+                return ret ;
             }
 
             //********************************************************************************
-            void_t on_physics( size_t const milli_dt ) noexcept
+            // returns false if the brick was gone already
+            bool_t destroy_brick( size_t const i ) noexcept
             {
-                if( !_is_init ) return ;
+                auto & b = _bricks[i] ;
+                if( !b.comp.is_visible ) return false ;
 
-                float_t const dt = (float_t(milli_dt) / 1000.0f) ;
+                b.comp.is_visible = false ;
+                --_played_state->alive ;
+                _score += 100 ;
 
-                // player
+                return true ;
+            }
+
+            //********************************************************************************
+            // splits the ball at p going in direction a into two going off at
+            // +-30 degrees of a. The ball itself turns by +30 degrees and one
+            // ball is added. a is not touched after the add as it may refer 
+            // into the extra balls.
+            void_t split_ball( natus::math::vec2f_t const p, natus::math::vec2f_t & a ) noexcept
+            {
+                if( _balls.size() >= _max_balls ) return ;
+
+                auto const turn = [&]( float_t const ang )
                 {
-                    _paddle.pos += natus::math::vec2f_t( 600.0f, 0.0f ) * 
-                        natus::math::vec2f_t( _paddle.comp.adv.x() * dt ) ;
+                    float_t const c = std::cos( ang ) ;
+                    float_t const s = std::sin( ang ) ;
+                    return natus::math::vec2f_t( a.x() * c - a.y() * s, a.x() * s + a.y() * c ) ;
+                } ;
 
-                    float_t const thres = 345.0f ;
-                    if( _paddle.pos.x() > thres || _paddle.pos.x() < -thres )
-                    {
-                        _paddle.pos = natus::math::vec2f_t( thres * natus::math::fn<float_t>::sign(_paddle.pos.x()), 
-                            _paddle.pos.y() ) ;
-                    }
+                natus::math::vec2f_t const other = turn( -0.5236f ) ;
+                a = turn( 0.5236f ) ;
+
+                _balls.add( p, other ) ;
+            }
+
+            //********************************************************************************
+            // spreads the stress balls over the bottom going upwards
+            void_t spawn_stress_balls( void_t ) noexcept
+            {
+                for( size_t i=0; i<_stress_balls; ++i )
+                {
+                    float_t const f = float_t( i ) / float_t( _stress_balls ) ;
+
+                    // 20 to 160 degrees
+                    float_t const ang = 0.349f + f * 2.443f ;
+                    _balls.add( natus::math::vec2f_t( -380.0f + 760.0f * f, -200.0f ), 
+                        natus::math::vec2f_t( std::cos( ang ), std::sin( ang ) ) * natus::math::vec2f_t( 1.414f ) ) ;
                 }
+            }
 
-                // ball
+            //********************************************************************************
+            void_t move_ball( prepared_level_cref_t lvl, float_t const dt ) noexcept
+            {
+                natus::math::vec2f_t const half = _ball.get_aabb().get_max() - _ball.pos ;
+                auto const hits = this_t::sweep_ball( lvl, _ball.pos, _ball.comp.adv, half, dt ) ;
+
+                if( hits.paddle )
                 {
-                    _ball.pos += natus::math::vec2f_t( 500.0f ) * 
-                        natus::math::vec2f_t( _ball.comp.adv * dt ) ;
+                    _audio_queue->push( audio_queue_t::producer::physics, _paddle.comp.hit_sid, natus::audio::execution_options::play ) ;
+                }
 
-                    natus::math::vec2f_t const thres = natus::math::vec2f_t( 400.0f, 300.0f ) ;
+                for( size_t i=0; i<hits.num_bricks; ++i )
+                {
+                    if( !this_t::destroy_brick( hits.bricks[i] ) ) continue ;
 
-                    // test y bottom hit
-                    if( _ball.pos.y() < -thres.y() )
-                    {
-                        _ball.pos = natus::math::vec2f_t(0.0f) ;
-                        _ball.comp.adv = natus::math::vec2f_t(1.0f,1.0f) ;
-                        --_paddle.comp.num_lifes ;
-                    }
+                    _audio_queue->push( audio_queue_t::producer::physics, _ball.comp.hit_sid, natus::audio::execution_options::play ) ;
 
-                    if( _ball.pos.x() > thres.x() || _ball.pos.x() < -thres.x() )
-                    {
-                        _ball.pos.x( natus::math::fn<float_t>::sign( _ball.pos.x() ) * thres.x() ) ;
-                        _ball.comp.adv.x( _ball.comp.adv.x() * -1.0f ) ; 
-                    }
+                    if( ++_bricks_destroyed % _split_every == 0 ) this_t::split_ball( _ball.pos, _ball.comp.adv ) ;
+                }
 
-                    if( _ball.pos.y() > thres.y() || _ball.pos.y() < -thres.y() )
-                    {
-                        _ball.pos.y( natus::math::fn<float_t>::sign( _ball.pos.y() ) * thres.y() ) ;
-                        _ball.comp.adv.y( _ball.comp.adv.y() * -1.0f ) ; 
-                    }
+                if( hits.bottom )
+                {
+                    _ball.pos = natus::math::vec2f_t(0.0f) ;
+                    _ball.prev_pos = _ball.pos ;
+                    _ball.comp.adv = natus::math::vec2f_t(1.0f,1.0f) ;
+                    --_paddle.comp.num_lifes ;
                 }
+            }
+
+            //********************************************************************************
+            // moves the extra balls in parallel. The bricks are only read while
+            // the balls move. The hits are applied afterwards in ball order, so
+            // the same balls always destroy the same bricks. Lost balls are 
+            // removed.
+            void_t move_balls( prepared_level_cref_t lvl, float_t const dt ) noexcept
+            {
+                if( _stress_balls > 0 && _balls.size() == 0 ) this_t::spawn_stress_balls() ;
+
+                size_t const n = _balls.size() ;
+
+                auto const tp = clock_t::now() ;
+
+                natus::math::vec2f_t const half = _ball.get_aabb().get_max() - _ball.pos ;
 
-                // ball paddle collision
+                _balls.hits.resize( n ) ;
+                parallel_for( n, _ball_grain, [&]( size_t const b, size_t const e )
                 {
-                    if( _paddle.get_aabb().is_overlapping( _ball.get_aabb() ) )
+                    for( size_t i=b; i<e; ++i )
                     {
-                        natus::math::vec3f_t const plane_l( -1.0f, +0.0f, -(_paddle.get_aabb().get_max() - _paddle.pos).x() ) ;
-                        natus::math::vec3f_t const plane_t( +0.0f, +1.0f, -(_paddle.get_aabb().get_max() - _paddle.pos).y() ) ;
-                        natus::math::vec3f_t const plane_r( +1.0f, +0.0f, -(_paddle.get_aabb().get_max() - _paddle.pos).x() ) ;
-                        natus::math::vec3f_t const plane_b( +0.0f, -1.0f, -(_paddle.get_aabb().get_max() - _paddle.pos).y() ) ;
-
-                        float_t const dist_l = plane_l.dot( natus::math::vec3f_t( _ball.pos - _paddle.pos, 1.0f ) ) ;
-                        float_t const dist_t = plane_t.dot( natus::math::vec3f_t( _ball.pos - _paddle.pos, 1.0f ) ) ;
-                        float_t const dist_r = plane_r.dot( natus::math::vec3f_t( _ball.pos - _paddle.pos, 1.0f ) ) ;
-                        float_t const dist_b = plane_b.dot( natus::math::vec3f_t( _ball.pos - _paddle.pos, 1.0f ) ) ;
+                        _balls.prev_pos[i] = _balls.pos[i] ;
+                        _balls.hits[i] = this_t::sweep_ball( lvl, _balls.pos[i], _balls.adv[i], half, dt ) ;
+                    }
+                } ) ;
 
-                        auto const b = natus::math::vec4f_t( dist_l, dist_r, dist_t, dist_b ).less_equal_than( natus::math::vec4f_t( 0.0f ) ) ;
+                bool_t paddle = false ;
+                bool_t brick = false ;
 
-                        if( b.x() && b.y() ) 
-                        {
-                            float_t const thres = 100.0f ;
-                            _ball.comp.adv = _ball.comp.adv * natus::math::vec2f_t( 1.0f, -1.0f ) ;
-                            if( std::abs( dist_r ) < thres )
-                            {
-                                auto const f = std::min( std::abs( dist_r ), thres ) / thres ;
-                                _ball.comp.adv.x( _paddle.comp.adv.x() * (1.0f - f) ) ;
-                            }
+                for( size_t i=0; i<n; ++i )
+                {
+                    auto const & h = _balls.hits[i] ;
+                    paddle = paddle || h.paddle ;
 
-                            else if( std::abs( dist_l ) < thres )
-                            {
-                                auto const f = std::min( std::abs( dist_l ), thres ) / thres ;
-                                _ball.comp.adv.x( _paddle.comp.adv.x() * (1.0f - f) ) ;
-                            }
-                        }
-                        else _ball.comp.adv = _ball.comp.adv * natus::math::vec2f_t( -1.0f, 1.0f ) ;
+                    for( size_t j=0; j<h.num_bricks; ++j )
+                    {
+                        if( !this_t::destroy_brick( h.bricks[j] ) ) continue ;
+                        brick = true ;
 
-                        {
-                            audio_queue_item item ;
-                            item.buffer = _paddle.comp.hit_sound ;
-                            item.eo = natus::audio::execution_options::play ;
-                            _audio_play_queue.emplace_back( item ) ;
-                        }
+                        if( ++_bricks_destroyed % _split_every == 0 ) 
+                            this_t::split_ball( _balls.pos[i], _balls.adv[i] ) ;
                     }
                 }
 
-                // ball brick collision
+                // split balls are added behind n and have no hits
+                _balls.remove_if( [&]( size_t const i ){ return i < n && _balls.hits[i].bottom ; } ) ;
+
+                // one sound each per step
+                if( paddle ) 
                 {
-                    for( auto & b : _bricks )
-                    {
-                        if( !b.comp.is_visible ) continue ;
+                    _audio_queue->push( audio_queue_t::producer::physics, _paddle.comp.hit_sid, natus::audio::execution_options::play ) ;
+                }
+                if( brick )
+                {
+                    _audio_queue->push( audio_queue_t::producer::physics, _ball.comp.hit_sid, natus::audio::execution_options::play ) ;
+                }
 
-                        if( b.get_aabb().is_overlapping( _ball.get_aabb() ) )
-                        {
-                            natus::math::vec3f_t const plane_l( -1.0f, +0.0f, -(b.get_aabb().get_max() - b.pos).x() ) ;
-                            natus::math::vec3f_t const plane_t( +0.0f, +1.0f, -(b.get_aabb().get_max() - b.pos).y() ) ;
-                            natus::math::vec3f_t const plane_r( +1.0f, +0.0f, -(b.get_aabb().get_max() - b.pos).x() ) ;
-                            natus::math::vec3f_t const plane_b( +0.0f, -1.0f, -(b.get_aabb().get_max() - b.pos).y() ) ;
+                if( _stress_balls == 0 ) return ;
+
+                _balls_us += size_t( std::chrono::duration_cast< std::chrono::microseconds >( clock_t::now() - tp ).count() ) ;
+                if( ++_balls_steps < 150 ) return ;
+
+                natus::log::global_t::status( "[multi ball] : " + std::to_string( _balls.size() ) + " balls, " + 
+                    std::to_string( _balls_us / _balls_steps ) + " us per step" ) ;
+                _balls_us = 0 ;
+                _balls_steps = 0 ;
+            }
+
+            //********************************************************************************
+            // called by logic after the sprite sheets were hot reloaded. The 
+            // ids are remapped at the start of the next physics step.
+            void_t on_sprite_sheets_changed( void_t ) noexcept
+            {
+                if( _commands->push( command::sheets ) ) return ;
+                natus::log::global_t::warning( "[hot reload] : command queue full. sheets not taken over" ) ;
+            }
 
-                            auto const to_ball = _ball.pos - b.pos ;
-                            float_t const dist_l = plane_l.dot( natus::math::vec3f_t( to_ball, 1.0f ) ) ;
-                            float_t const dist_t = plane_t.dot( natus::math::vec3f_t( to_ball, 1.0f ) ) ;
-                            float_t const dist_r = plane_r.dot( natus::math::vec3f_t( to_ball, 1.0f ) ) ;
-                            float_t const dist_b = plane_b.dot( natus::math::vec3f_t( to_ball, 1.0f ) ) ;
+            //********************************************************************************
+            // remaps the ids from the sheets physics played with to the newest
+            // published sheets. Reloads published in between are skipped.
+            void_t take_over_sheets( void_t ) noexcept
+            {
+                auto to_ptr = _init_data.sheets->load() ;
+                if( to_ptr == nullptr || to_ptr == _sheets ) return ;
 
-                            auto const bin = natus::math::vec4f_t( dist_l, dist_r, dist_t, dist_b ).less_equal_than( natus::math::vec4f_t( 0.0f ) ) ;
+                auto const from_ptr = std::move( _sheets ) ;
+                _sheets = to_ptr ;
 
-                            if( bin.x() && bin.y() ) _ball.comp.adv = _ball.comp.adv * natus::math::vec2f_t( 1.0f, -1.0f ) ;
-                            else _ball.comp.adv = _ball.comp.adv * natus::math::vec2f_t( -1.0f, 1.0f ) ;
+                size_t const sheet = 0 ;
+                if( from_ptr == nullptr || from_ptr->size() <= sheet || to_ptr->size() <= sheet ) return ;
 
-                            b.comp.is_visible = false ;
+                auto const & from = *from_ptr ;
+                auto const & to = *to_ptr ;
 
-                            _score += 100 ;
+                auto & bricks = _bricks ;
 
-                            {
-                                audio_queue_item item ;
-                                item.buffer = _ball.comp.hit_sound ;
-                                item.eo = natus::audio::execution_options::play ;
-                                _audio_play_queue.emplace_back( item ) ;
-                            }
+                _paddle.remap( from[sheet], to[sheet] ) ;
+                _ball.remap( from[sheet], to[sheet] ) ;
 
-                            break ;
-                        }
+                // all bricks share the ids so only remap once
+                if( bricks.size() > 0 )
+                {
+                    auto b = bricks[0] ;
+                    b.remap( from[sheet], to[sheet] ) ;
+
+                    for( auto & br : bricks )
+                    {
+                        br.obj_id = b.obj_id ;
+                        br.ani_id = b.ani_id ;
+                        br.max_ani_time = b.max_ani_time ;
+                        br.anim_time = br.anim_time % br.max_ani_time ;
                     }
                 }
+
+                // the prefetched level was prepared with the old ids
+                this_t::prefetch_next_level() ;
             }
 
             //********************************************************************************
             void_t on_audio( natus::audio::async_access_t audio ) noexcept
             {
-                for( auto & b : _audio_play_queue )
-                {
-                    natus::audio::backend::execute_detail ed ;
-                    ed.to = b.eo ;
-                    ed.loop = b.loop ;
-                    audio.execute( b.buffer, ed ) ;
-                }
-                _audio_play_queue.clear() ;
+                _audio_queue->drain( audio ) ;
             }
 
             //********************************************************************************
-            void_t on_graphics( natus::gfx::sprite_render_2d_res_t sr, natus::gfx::sprite_sheets_cref_t sheets, size_t const milli_dt ) noexcept
+            // captures everything that is drawn into the producer slot and 
+            // publishes it. Slots are reused so no allocation after warm up.
+            void_t publish_snapshot( void_t ) noexcept
             {
-                if( !_is_init ) return ;
-
-                size_t const sheet = 0 ;
+                auto & snap = _snapshots->write_slot() ;
+                snap.sprites.clear() ;
+                snap.lives.clear() ;
+                snap.boxes.clear() ;
+                snap.has_ball = false ;
+
+                auto const item = [&]( natus::math::vec2f_t const & prev_pos, natus::math::vec2f_t const & pos, float_t const scale, 
+                    natus::gfx::sprite_sheet::sprite const & s, natus::math::vec4f_t const & color )
+                {
+                    return sprite_item_t { prev_pos, pos, natus::math::vec2f_t( scale ), s.rect, s.pivot, color } ;
+                } ;
 
                 // bricks
                 {
@@ -744,124 +1905,132 @@ namespace paddle_n_ball
                         natus::math::vec4f_t( 1.0f, 0.0f, 0.0f, 1.0f ) 
                     } ;
 
-                    for( size_t y=0; y<_level.h; ++y )
+                    for( auto const & ent : _bricks )
                     {
-                        for( size_t x=0; x<_level.w; ++x )
-                        {
-                            size_t const idx = y * _level.w + x ;
-                            auto const & ent = _bricks[ idx ] ;
+                        snap.boxes.emplace_back( ent.get_bb() ) ;
+                        if( ent.hit || !ent.comp.is_visible ) continue ;
 
-                            if( !ent.hit && ent.comp.is_visible )
-                            {
-                                sr->draw( 0, 
-                                    ent.pos, 
-                                    natus::math::mat2f_t().identity(),
-                                    natus::math::vec2f_t(ent.scale),
-                                    ent.cur_sprite.rect,  
-                                    sheet, ent.cur_sprite.pivot, 
-                                    colors[5 - (ent.obj_id % 6)] ) ;
-                            }
-                        }
+                        snap.sprites.emplace_back( item( ent.pos, ent.pos, ent.scale, ent.cur_sprite, 
+                            colors[5 - ((ent.obj_id + ent.comp.kind - 1) % 6)] ) ) ;
                     }
                 }
 
                 // player
                 if( _paddle.ani_id != size_t(-1) )
                 {
-                    sr->draw( 0, 
-                        _paddle.pos, 
-                        natus::math::mat2f_t().identity(),
-                        natus::math::vec2f_t(_paddle.scale),
-                        _paddle.cur_sprite.rect,  
-                        sheet, _paddle.cur_sprite.pivot, 
-                        natus::math::vec4f_t(1.0f) ) ;
+                    snap.sprites.emplace_back( item( _paddle.prev_pos, _paddle.pos, _paddle.scale, 
+                        _paddle.cur_sprite, natus::math::vec4f_t(1.0f) ) ) ;
+                    snap.boxes.emplace_back( _paddle.get_bb() ) ;
                 }
 
                 // ball
                 if( _ball.ani_id != size_t(-1) )
                 {
-                    sr->draw( 0, 
-                        _ball.pos, 
-                        natus::math::mat2f_t().identity(),
-                        natus::math::vec2f_t(_ball.scale),
-                        _ball.cur_sprite.rect,  
-                        sheet, _ball.cur_sprite.pivot, 
-                        natus::math::vec4f_t(1.0f) ) ;
+                    snap.has_ball = true ;
+                    snap.ball = item( _ball.prev_pos, _ball.pos, _ball.scale, _ball.cur_sprite, natus::math::vec4f_t(1.0f) ) ;
+                    snap.boxes.emplace_back( _ball.get_bb() ) ;
 
                     for( size_t i=0; i<_paddle.comp.num_lifes; ++i )
                     {
-                        sr->draw( 0, 
-                            natus::math::vec2f_t(-390.0f, 283.0f ) + natus::math::vec2f_t( float_t(i)*10.0f, 0.0f ), 
-                            natus::math::mat2f_t().rotation( natus::math::angle<float_t>::degree_to_radian(90.0f) ),
-                            natus::math::vec2f_t(_ball.scale*0.75f),
-                            _ball.cur_sprite.rect,  
-                            sheet, _paddle.cur_sprite.pivot, 
-                            natus::math::vec4f_t(1.0f) ) ;
+                        auto const p = natus::math::vec2f_t(-390.0f, 283.0f ) + natus::math::vec2f_t( float_t(i)*10.0f, 0.0f ) ;
+                        auto l = item( p, p, _ball.scale*0.75f, _ball.cur_sprite, natus::math::vec4f_t(1.0f) ) ;
+                        l.pivot = _paddle.cur_sprite.pivot ;
+                        snap.lives.emplace_back( l ) ;
                     }
+                }
 
-                    // this just tests smoothness of the rendering.
-                    #if 0
-                    {
-                        static float_t inter = 0.0f ;
-                        float_t v = natus::math::interpolation<float_t>::linear( 0.0f, 1.0f, inter ) *2.0f-1.0f ;
-                        v *= 400 ;
+                // extra balls
+                if( _balls.size() == 0 )
+                {
+                    snap.balls_pos.clear() ;
+                    snap.balls_prev_pos.clear() ;
+                }
+                else
+                {
+                    snap.balls_pos.assign( _balls.pos.begin(), _balls.pos.end() ) ;
+                    snap.balls_prev_pos.assign( _balls.prev_pos.begin(), _balls.prev_pos.end() ) ;
+                }
 
-                        sr->draw( 0, 
-                            natus::math::vec2f_t( v, -200.0f ), 
-                            natus::math::mat2f_t().rotation( natus::math::angle<float_t>::degree_to_radian(90.0f) ),
-                            natus::math::vec2f_t(_ball.scale*0.75f),
-                            _ball.cur_sprite.rect,  
-                            sheet, _paddle.cur_sprite.pivot, 
-                            natus::math::vec4f_t(1.0f) ) ;
+                snap.score = _score ;
 
-                        //inter += (float_t( milli_dt ) / 1000.0f)*0.5f ;
-                        inter += 0.016f*0.5f ;
-                        if( inter > 1.0f ) inter = 0.0f ;
-                    }
-                    #endif
-                }
+                _snapshots->publish() ;
             }
 
             //********************************************************************************
-            void_t on_debug_graphics( natus::gfx::primitive_render_2d_res_t pr, natus::gfx::sprite_sheets_cref_t sheets, size_t const milli_dt ) noexcept
+            // draws the latest published snapshot. alpha interpolates the moving
+            // entities between the previous and the current physics step.
+            void_t on_graphics( natus::gfx::sprite_render_2d_res_t sr, natus::gfx::sprite_sheets_cref_t, 
+                size_t const, float_t const alpha ) noexcept
             {
-                if( !_is_init ) return ;
-               
-                // player box
-                {
-                    auto const & entity = _paddle ;
-                    if( entity.ani_id != size_t(-1) )
-                    {
-                        auto const bb = entity.get_bb() ;
+                size_t const sheet = 0 ;
 
-                        natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
-                        natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
+                _drawn = &_snapshots->read() ;
 
-                        pr->draw_rect( 50, bb.box[0], bb.box[1], bb.box[2], bb.box[3], color0, color1 ) ;
-                    }
+                auto const lerp = [&]( sprite_item_cref_t s )
+                {
+                    return s.prev_pos + (s.pos - s.prev_pos) * natus::math::vec2f_t( alpha ) ;
+                } ;
+
+                // bricks and player
+                for( auto const & s : _drawn->sprites )
+                {
+                    sr->draw( 0, lerp( s ), 
+                        natus::math::mat2f_t().identity(),
+                        s.scale,
+                        s.rect,  
+                        sheet, s.pivot, 
+                        s.color ) ;
                 }
 
-                // ball box
+                // ball
+                if( _drawn->has_ball )
                 {
-                    auto const & entity = _ball ;
-                    if( entity.ani_id != size_t(-1) )
-                    {
-                        auto const bb = entity.get_bb() ;
+                    auto const & b = _drawn->ball ;
 
-                        natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
-                        natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
+                    sr->draw( 0, lerp( b ), 
+                        natus::math::mat2f_t().identity(),
+                        b.scale,
+                        b.rect,  
+                        sheet, b.pivot, 
+                        b.color ) ;
 
-                        pr->draw_rect( 50, bb.box[0], bb.box[1], bb.box[2], bb.box[3], color0, color1 ) ;
+                    // extra balls
+                    for( size_t i=0; i<_drawn->balls_pos.size(); ++i )
+                    {
+                        auto const p = _drawn->balls_prev_pos[i] + 
+                            (_drawn->balls_pos[i] - _drawn->balls_prev_pos[i]) * natus::math::vec2f_t( alpha ) ;
+
+                        sr->draw( 0, p, 
+                            natus::math::mat2f_t().identity(),
+                            b.scale,
+                            b.rect,  
+                            sheet, b.pivot, 
+                            b.color ) ;
                     }
                 }
 
-                for( auto & entity : _bricks )
+                for( auto const & s : _drawn->lives )
                 {
-                    auto const bb = entity.get_bb() ;
+                    sr->draw( 0, s.pos, 
+                        natus::math::mat2f_t().rotation( natus::math::angle<float_t>::degree_to_radian(90.0f) ),
+                        s.scale,
+                        s.rect,  
+                        sheet, s.pivot, 
+                        s.color ) ;
+                }
+            }
+
+            //********************************************************************************
+            // requires on_graphics to be called before in the same frame
+            void_t on_debug_graphics( natus::gfx::primitive_render_2d_res_t pr, natus::gfx::sprite_sheets_cref_t, size_t const ) noexcept
+            {
+                if( _drawn == nullptr ) return ;
 
-                    natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
-                    natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
+                natus::math::vec4f_t color0( 1.0f, 1.0f, 1.0f, 0.5f ) ;
+                natus::math::vec4f_t color1( 1.0f, 1.0f, 1.0f, 1.0f ) ;
 
+                for( auto const & bb : _drawn->boxes )
+                {
                     pr->draw_rect( 50, bb.box[0], bb.box[1], bb.box[2], bb.box[3], color0, color1 ) ;
                 }
             }
@@ -876,6 +2045,17 @@ namespace paddle_n_ball
     {
         natus_this_typedefs( game_app ) ;
 
+        typedef std::chrono::high_resolution_clock clock_t ;
+
+    private: // startup
+
+        startup_trace_ptr_t _trace ;
+
+    private: // timing
+
+        // physics runs in fixed steps and animates the game
+        fixed_step_t _physics_step { 30 } ;
+
     private: // device
 
         natus::device::three_device_res_t _dev_mouse ;
@@ -916,7 +2096,11 @@ namespace paddle_n_ball
     private: // sprite tool
 
         natus::tool::sprite_editor_res_t _se ;
-        natus::gfx::sprite_sheets_res_t _sheets ;
+
+    private: // sprite sheet hot reload
+
+        sheet_reload_t _sheet_reload ;
+        natus::graphics::image_object_res_t _image_array ;
 
     private: // private
 
@@ -928,7 +2112,7 @@ namespace paddle_n_ball
 
     public:
 
-        game_app( void_t ) 
+        game_app( bool_t const stress ) 
         {
             natus::application::app::window_info_t wi ;
             #if 1
@@ -958,6 +2142,8 @@ namespace paddle_n_ball
             _db = natus::io::database_t( natus::io::path_t( DATAPATH ), "./working", "data" ) ;
             _se = natus::tool::sprite_editor_res_t( natus::tool::sprite_editor_t( _db )  ) ;
             _audio = this_t::create_audio_engine() ;
+
+            _game.set_stress( stress ) ;
         }
         game_app( this_cref_t ) = delete ;
         game_app( this_rref_t rhv ) : app( ::std::move( rhv ) ) 
@@ -1021,8 +2207,32 @@ namespace paddle_n_ball
 
     private:
 
+        //********************************************************************************
+        // takes over a finished sprite sheet reload. The image array is only 
+        // re-uploaded if an image changed.
+        void_t hot_reload_sprite_sheets( void_t ) noexcept
+        {
+            if( !_image_array.is_valid() ) return ;
+
+            sheet_reload_t::change_t c ;
+            if( !_sheet_reload.poll( c ) ) return ;
+
+            if( c.images_changed )
+            {
+                _image_array = sheet_reload_t::make_image_array( std::move( c.imgs ) ) ;
+                _graphics.for_each( [&]( natus::graphics::async_view_t a )
+                {
+                    a.configure( _image_array ) ;
+                } ) ;
+            }
+
+            _game.on_sprite_sheets_changed() ;
+        }
+
         virtual natus::application::result on_init( void_t ) noexcept
         { 
+            _trace = std::make_shared< startup_trace_t >( "paddle_n_ball", DATAPATH "/startup_report.json" ) ;
+
             natus::device::global_t::system()->search( [&] ( natus::device::idevice_res_t dev_in )
             {
                 if( natus::device::three_device_res_t::castable( dev_in ) )
@@ -1052,6 +2262,8 @@ namespace paddle_n_ball
 
             // root render states
             {
+                auto const ph = _trace->begin( "root render states" ) ;
+
                 natus::graphics::state_object_t so = natus::graphics::state_object_t(
                     "root_render_states" ) ;
 
@@ -1081,10 +2293,14 @@ namespace paddle_n_ball
                 {
                     a.configure( _root_render_states ) ;
                 } ) ;
+
+                _trace->end( ph ) ;
             }
 
             // root render states
             {
+                auto const ph = _trace->begin( "framebuffer render states" ) ;
+
                 natus::graphics::state_object_t so = natus::graphics::state_object_t(
                     "fb_render_states" ) ;
 
@@ -1118,167 +2334,73 @@ namespace paddle_n_ball
                 {
                     a.configure( _fb_render_states ) ;
                 } ) ;
+
+                _trace->end( ph ) ;
             }
 
             // import natus file
             {
-                _sheets = natus::gfx::sprite_sheets_t() ;
-
-                natus::format::module_registry_res_t mod_reg = natus::format::global_t::registry() ;
-                auto item = mod_reg->import_from( natus::io::location_t( "sprite_sheet.natus" ), _db ) ;
+                _sheet_reload.init( _db, _trace ) ;
 
-                natus::format::natus_item_res_t ni = item.get() ;
-                if( ni.is_valid() )
+                natus::graphics::image_t imgs ;
+                if( _sheet_reload.load( imgs ) )
                 {
-                    natus::format::natus_document_t doc = std::move( ni->doc ) ;
-
-                    // taking all slices
-                    natus::graphics::image_t imgs ;
-
-                    // load images
-                    {
-                        natus::ntd::vector< natus::format::future_item_t > futures ;
-                        for( auto const & ss : doc.sprite_sheets )
-                        {
-                            auto const l = natus::io::location_t::from_path( natus::io::path_t(ss.image.src) ) ;
-                            futures.emplace_back( mod_reg->import_from( l, _db ) ) ;
-                        }
-
-                    
-                        for( size_t i=0; i<doc.sprite_sheets.size(); ++i )
-                        {
-                            natus::format::image_item_res_t ii = futures[i].get() ;
-                            if( ii.is_valid() )
-                            {
-                                imgs.append( *ii->img ) ;
-                            }
-
-                            natus::gfx::sprite_sheet ss ;
-                            _sheets->emplace_back( ss ) ;
-                        }
-                    }
-
-                    // make sprite animation infos
-                    {
-                        // as an image array is used, the max dims need to be
-                        // used to compute the particular rect infos
-                        auto dims = imgs.get_dims() ;
-                    
-                        size_t i=0 ;
-                        for( auto const & ss : doc.sprite_sheets )
-                        {
-                            auto & sheet = (*_sheets)[i++] ;
-
-                            for( auto const & s : ss.sprites )
-                            {
-                                natus::math::vec4f_t const rect = 
-                                    (natus::math::vec4f_t( s.animation.rect ) + 
-                                        natus::math::vec4f_t(0.0f,0.0f, 1.0f, 1.0f))/ 
-                                    natus::math::vec4f_t( dims.xy(), dims.xy() )  ;
-
-                                natus::math::vec2f_t const pivot =
-                                    natus::math::vec2f_t( s.animation.pivot ) / 
-                                    natus::math::vec2f_t( dims.xy() ) ;
-
-                                natus::gfx::sprite_sheet::sprite s_ ;
-                                s_.rect = rect ;
-                                s_.pivot = pivot ;
-
-                                sheet.rects.emplace_back( s_ ) ;
-                            }
-
-                            natus::ntd::map< natus::ntd::string_t, size_t > object_map ;
-
-                            for( auto const & a : ss.animations )
-                            {
-                                size_t obj_id = 0 ;
-                                {
-                                    auto iter = object_map.find( a.object ) ;
-                                    if( iter != object_map.end() ) obj_id = iter->second ;
-                                    else 
-                                    {
-                                        obj_id = sheet.objects.size() ;
-                                        sheet.objects.emplace_back( natus::gfx::sprite_sheet::object { a.object, {} } ) ;
-                                    }
-                                }
-
-                                natus::gfx::sprite_sheet::animation a_ ;
-
-                                size_t tp = 0 ;
-                                for( auto const & f : a.frames )
-                                {
-                                    auto iter = std::find_if( ss.sprites.begin(), ss.sprites.end(), 
-                                        [&]( natus::format::natus_document_t::sprite_sheet_t::sprite_cref_t s )
-                                    {
-                                        return s.name == f.sprite ;
-                                    } ) ;
-                                    if( iter == ss.sprites.end() )
-                                    {
-                                        natus::log::global_t::error("can not find sprite [" + f.sprite + "]" ) ;
-                                        continue ;
-                                    }
-                                    size_t const d = std::distance( ss.sprites.begin(), iter ) ;
-                                    natus::gfx::sprite_sheet::animation::sprite s_ ;
-                                    s_.begin = tp ;
-                                    s_.end = tp + f.duration ;
-                                    s_.idx = d ;
-                                    a_.sprites.emplace_back( s_ ) ;
-
-                                    tp = s_.end ;
-                                }
-                                a_.duration = tp ;
-                                a_.name = a.name ;
-
-                                sheet.objects[obj_id].animations.emplace_back( std::move( a_ ) ) ;
-                            }
-                        }
-                    }
+                    auto const ph_img = _trace->begin( "image array" ) ;
+                    size_t const img_bytes = size_t( imgs.get_dims().x() * imgs.get_dims().y() * imgs.get_dims().z() ) * 4 ;
 
-                    natus::graphics::image_object_res_t ires = natus::graphics::image_object_t( 
-                        "image_array", std::move( imgs ) )
-                        .set_type( natus::graphics::texture_type::texture_2d_array )
-                        .set_wrap( natus::graphics::texture_wrap_mode::wrap_s, natus::graphics::texture_wrap_type::repeat )
-                        .set_wrap( natus::graphics::texture_wrap_mode::wrap_t, natus::graphics::texture_wrap_type::repeat )
-                        .set_filter( natus::graphics::texture_filter_mode::min_filter, natus::graphics::texture_filter_type::nearest )
-                        .set_filter( natus::graphics::texture_filter_mode::mag_filter, natus::graphics::texture_filter_type::nearest );
+                    _image_array = sheet_reload_t::make_image_array( std::move( imgs ) ) ;
 
                     _graphics.for_each( [&]( natus::graphics::async_view_t a )
                     {
-                        a.configure( ires ) ;
+                        a.configure( _image_array ) ;
                     } ) ;
+
+                    _trace->end( ph_img, img_bytes ) ;
                 }
             }
 
             // prepare sprite render
             {
+                auto const ph = _trace->begin( "prepare sprite render" ) ;
+
                 _sr = natus::gfx::sprite_render_2d_res_t( natus::gfx::sprite_render_2d_t() ) ;
                 _sr->init( "sprite_render", "image_array", _graphics ) ;
+
+                _trace->end( ph ) ;
             }
             
             // prepare primitive
             {
+                auto const ph = _trace->begin( "prepare primitive" ) ;
+
                 _pr = natus::gfx::primitive_render_2d_res_t( natus::gfx::primitive_render_2d_t() ) ;
                 _pr->init( "prim_render", _graphics ) ;
+
+                _trace->end( ph ) ;
             }
 
             // tool sprite
             {
+                auto const ph = _trace->begin( "tool sprite" ) ;
+
                 _se->add_sprite_sheet( "sprites", natus::io::location_t( "images.paddle_n_ball.png" ) ) ;
                 //_se->add_sprite_sheet( "enemies", natus::io::location_t( "images.Paper-Pixels-8x8.Enemies.png" ) ) ;
                 //_se->add_sprite_sheet( "player", natus::io::location_t( "images.Paper-Pixels-8x8.Player.png" ) ) ;
                 //_se->add_sprite_sheet( "tiles", natus::io::location_t( "images.Paper-Pixels-8x8.Tiles.png" ) ) ;
                 
+
+                _trace->end( ph ) ;
             }
 
             // import fonts and create text render
             {
+                auto const ph = _trace->begin( "font raster" ) ;
+
                 natus::property::property_sheet_res_t ps = natus::property::property_sheet_t() ;
 
                 {
-                    natus::font::code_points_t pts ;
-                    for( uint32_t i = 33; i <= 126; ++i ) pts.emplace_back( i ) ;
-                    for( uint32_t i : {uint32_t( 0x00003041 )} ) pts.emplace_back( i ) ;
-                    ps->set_value< natus::font::code_points_t >( "code_points", pts ) ;
+                    ps->set_value< natus::font::code_points_t >( "code_points", 
+                        make_code_points( { TITLE, "0123456789" } ) ) ;
                 }
 
                 #if 0
@@ -1306,10 +2428,14 @@ namespace paddle_n_ball
                     _tr = natus::gfx::text_render_2d_res_t( natus::gfx::text_render_2d_t( "text_render", _graphics ) ) ;
                     _tr->init( std::move( *ii->obj ), NUM_LAYERS ) ;
                 }
+
+                _trace->end( ph, startup_trace_t::file_size( "fonts/LCD_Solid.ttf" ) ) ;
             }
 
             // framebuffer
             {
+                auto const ph = _trace->begin( "framebuffer" ) ;
+
                 _fb = natus::graphics::framebuffer_object_t( "the_scene" ) ;
                 _fb->set_target( natus::graphics::color_target_type::rgba_uint_8, 1 )
                     .resize( size_t(_screen_target.x()), size_t(_screen_target.y()) ) ;
@@ -1318,20 +2444,27 @@ namespace paddle_n_ball
                 {
                     a.configure( _fb ) ;
                 } ) ;
+
+                _trace->end( ph, size_t(_screen_target.x()) * size_t(_screen_target.y()) * 4 ) ;
             }
 
             // prepare quad
             {
+                auto const ph = _trace->begin( "prepare quad" ) ;
+
                 _quad = natus::gfx::quad_res_t( natus::gfx::quad_t("post_map") ) ;
                 _quad->init( _graphics ) ;
                 _quad->set_texture("the_scene.0") ;
+
+                _trace->end( ph ) ;
             }
 
             {
                 the_game::init_data id ;
                 id.db = _db ;
-                id.sheets = _sheets ;
+                id.sheets = _sheet_reload.current() ;
                 id.audio = _audio ;
+                id.trace = _trace ;
 
                 natus::concurrent::global_t::schedule( _game.on_init( std::move( id ) ), 
                     natus::concurrent::schedule_type::loose ) ;
@@ -1470,6 +2603,9 @@ namespace paddle_n_ball
                 }
             }
 
+            // app phases are done. game phases may still run in the background.
+            _trace->seal() ;
+
             return natus::application::result::ok ; 
         }
 
@@ -1504,9 +2640,11 @@ namespace paddle_n_ball
             return natus::application::result::ok ; 
         }
 
-        virtual natus::application::result on_logic( logic_data_in_t d ) noexcept 
+        virtual natus::application::result on_logic( logic_data_in_t ) noexcept 
         { 
-            _game.on_logic( *_sheets, d.micro_dt / 1000 ) ;
+            this_t::hot_reload_sprite_sheets() ;
+
+            _game.on_logic() ;
 
             //NATUS_PROFILING_COUNTER_HERE( "Logic Clock" ) ;
             return natus::application::result::ok ; 
@@ -1527,7 +2665,10 @@ namespace paddle_n_ball
         virtual natus::application::result on_physics( natus::application::app_t::physics_data_in_t pd ) noexcept
         { 
             //natus::log::global_t::status( "physics: " + std::to_string( pd.micro_dt ) ) ;
-            _game.on_physics( pd.micro_dt / 1000 ) ;
+            _physics_step.advance( pd.micro_dt, [&]( size_t const step_us )
+            {
+                _game.on_physics( step_us ) ;
+            } ) ;
             //NATUS_PROFILING_COUNTER_HERE( "Physics Clock" ) ;
             return natus::application::result::ok ; 
         }
@@ -1566,20 +2707,20 @@ namespace paddle_n_ball
 
             {
                 _tr->draw_text( 0, 0, 10, natus::math::vec2f_t(-0.1f, 0.7f), 
-                    natus::math::vec4f_t(1.0f), "Paddle'n'Ball" ) ;
+                    natus::math::vec4f_t(1.0f), TITLE ) ;
             }
 
             {
-                _game.on_graphics( _sr, *_sheets, rdi.micro_dt / 1000) ;
+                _game.on_graphics( _sr, *_sheet_reload.sheets(), rdi.micro_dt / 1000, _physics_step.alpha() ) ;
                 
                 _tr->draw_text( 0, 0, 10, natus::math::vec2f_t(-.85f, 0.7f), 
-                    natus::math::vec4f_t(1.0f), std::to_string( _game.get_score()) ) ;
+                    natus::math::vec4f_t(1.0f), std::to_string( _game.get_drawn_score()) ) ;
             
             }
 
             if( _draw_debug )
             {
-                _game.on_debug_graphics( _pr, *_sheets, rdi.milli_dt ) ;
+                _game.on_debug_graphics( _pr, *_sheet_reload.sheets(), rdi.milli_dt ) ;
             }
 
             // render renderer
@@ -1637,6 +2778,18 @@ namespace paddle_n_ball
             {
                 ImGui::Checkbox( "Draw Debug", &_draw_debug ) ;
                 ImGui::Text( "Display Resolution : %.2f, %.2f", _screen_current.x(), _screen_current.y() ) ;
+
+                if( ImGui::Button( "Convert Layouts" ) )
+                {
+                    natus::concurrent::global_t::schedule( _game.convert_layouts_task( false ), 
+                        natus::concurrent::schedule_type::loose ) ;
+                }
+                ImGui::SameLine() ;
+                if( ImGui::Button( "Convert Layouts (RLE)" ) )
+                {
+                    natus::concurrent::global_t::schedule( _game.convert_layouts_task( true ), 
+                        natus::concurrent::schedule_type::loose ) ;
+                }
             }
             ImGui::End() ;
 
@@ -1657,7 +2810,12 @@ namespace paddle_n_ball
 
 int main( int argc, char ** argv )
 {
+    // --stress : keep 10k extra balls in play and log the time they take
+    bool stress = false ;
+    for( int i=1; i<argc; ++i ) 
+        stress = stress || std::strcmp( argv[i], "--stress" ) == 0 ;
+
     return natus::application::global_t::create_application( 
-        paddle_n_ball::game_app_res_t( paddle_n_ball::game_app_t() ) )->exec() ;
+        paddle_n_ball::game_app_res_t( paddle_n_ball::game_app_t( stress ) ) )->exec() ;
 }
  
\ No newline at end of file
@@ -37,13 +37,86 @@
 #include <natus/math/utility/angle.hpp>
 #include <natus/math/utility/3d/transformation.hpp>
 
+#include <common/spsc_ring.hpp>
+#include <common/fixed_step.hpp>
+#include <common/code_points.hpp>
+#include <common/parallel_for.hpp>
+#include <common/input_queue.hpp>
+#include <common/startup_trace.hpp>
+#include <common/versioned_ptr.hpp>
+
 #include <thread>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <bitset>
+#include <array>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cstdlib>
 
 namespace paddle_n_ball
 {
     static size_t const NUM_LAYERS = 100 ;
 
+    // all text drawn besides the score
+    static char const * const TITLE = "Tetrix" ;
+
     using namespace natus::core::types ;
+    using namespace games ;
+
+    // a cell relative to the pivot of a piece
+    struct piece_cell
+    {
+        int_t x ;
+        int_t y ;
+    };
+
+    // the cells of a piece in every rotation. Rotations go clockwise and 
+    // the first cell is the pivot.
+    struct piece_shape
+    {
+        size_t num_cells ;
+        piece_cell cells[4][5] ;
+    };
+
+    static constexpr size_t NUM_ROTATIONS = 4 ;
+    static constexpr size_t NUM_PIECES = 3 ;
+
+    static constexpr piece_shape PIECES[NUM_PIECES] = 
+    {
+        // L
+        { 5, {
+            { {0,0}, {1,0}, {0,1}, {0,2}, {0,3} },
+            { {0,0}, {0,-1}, {1,0}, {2,0}, {3,0} },
+            { {0,0}, {-1,0}, {0,-1}, {0,-2}, {0,-3} },
+            { {0,0}, {0,1}, {-1,0}, {-2,0}, {-3,0} } } },
+
+        // rect
+        { 4, {
+            { {0,0}, {0,1}, {1,0}, {1,1} },
+            { {0,0}, {0,1}, {1,0}, {1,1} },
+            { {0,0}, {0,1}, {1,0}, {1,1} },
+            { {0,0}, {0,1}, {1,0}, {1,1} } } },
+
+        // |
+        { 4, {
+            { {0,0}, {0,1}, {0,2}, {0,3} },
+            { {0,0}, {1,0}, {2,0}, {3,0} },
+            { {0,0}, {0,1}, {0,2}, {0,3} },
+            { {0,0}, {1,0}, {2,0}, {3,0} } } }
+    } ;
+
+    // pivot offsets tried in order if a rotated piece does not fit
+    static constexpr size_t NUM_KICKS = 6 ;
+    static constexpr piece_cell KICKS[NUM_KICKS] = 
+    {
+        {0,0}, {-1,0}, {1,0}, {0,1}, {-2,0}, {2,0}
+    } ;
 
     class the_game
     {
@@ -153,18 +226,322 @@ namespace paddle_n_ball
 
         private: // 
 
+            // one bit per cell. A row is a run of 64 bit words where cell x
+            // is bit x % 64 of word x / 64, so the default board is one word
+            // per row.
             struct level
             {
+                natus_this_typedefs( level ) ;
+
                 size_t w = 40 ;
                 size_t h = 60 ;
 
-                natus::ntd::vector< size_t > layout ;
+                // words per row
+                size_t words = 1 ;
+                natus::ntd::vector< uint64_t > rows ;
+
+                // set cells per row. rows from top on are empty.
+                natus::ntd::vector< size_t > fill ;
+                size_t top = 0 ;
+
+                // the lowest row that became full since the last clear
+                size_t lowest_full = size_t( -1 ) ;
+
+                // per column the row above the topmost set cell and the 
+                // empty cells below it
+                natus::ntd::vector< size_t > heights ;
+                natus::ntd::vector< size_t > holes ;
+                size_t total_holes = 0 ;
+
+                // the level is split into CHUNK x CHUNK cell tiles. A tile
+                // gets a new revision on every change so anything derived
+                // from it, like its drawing, can be kept until it changes.
+                static constexpr size_t CHUNK = 32 ;
+                size_t chunks_x = 1 ;
+                size_t chunks_y = 1 ;
+                natus::ntd::vector< size_t > revs ;
+                size_t last_rev = 0 ;
+
+                void_t resize( size_t const w_, size_t const h_ ) noexcept
+                {
+                    w = w_ ;
+                    h = h_ ;
+                    words = (w + 63) / 64 ;
+                    rows.clear() ;
+                    rows.resize( words * h, 0 ) ;
+                    fill.clear() ;
+                    fill.resize( h, 0 ) ;
+                    top = 0 ;
+                    lowest_full = size_t( -1 ) ;
+                    heights.clear() ;
+                    heights.resize( w, 0 ) ;
+                    holes.clear() ;
+                    holes.resize( w, 0 ) ;
+                    total_holes = 0 ;
+                    chunks_x = (w + CHUNK - 1) / CHUNK ;
+                    chunks_y = (h + CHUNK - 1) / CHUNK ;
+                    revs.clear() ;
+                    revs.resize( chunks_x * chunks_y, ++last_rev ) ;
+                }
+
+                size_t chunk_rev( size_t const cx, size_t const cy ) const noexcept 
+                { 
+                    return revs[ cy * chunks_x + cx ] ; 
+                }
+
+                void_t touch( size_t const x, size_t const y ) noexcept
+                {
+                    revs[ (y / CHUNK) * chunks_x + x / CHUNK ] = ++last_rev ;
+                }
+
+                // touches all chunks with cells in rows [y0,y1)
+                void_t touch_rows( size_t const y0, size_t const y1 ) noexcept
+                {
+                    if( y0 >= y1 ) return ;
+
+                    size_t const rev = ++last_rev ;
+                    std::fill( revs.begin() + (y0 / CHUNK) * chunks_x, 
+                        revs.begin() + ((y1 - 1) / CHUNK + 1) * chunks_x, rev ) ;
+                }
+
+                static size_t count_bits( uint64_t const v ) noexcept
+                {
+                    return std::bitset< 64 >( v ).count() ;
+                }
+
+                uint64_t const * row( size_t const y ) const noexcept { return rows.data() + y * words ; }
+                uint64_t * row( size_t const y ) noexcept { return rows.data() + y * words ; }
+
+                // the bits of word i that are inside the board
+                uint64_t full_mask( size_t const i ) const noexcept
+                {
+                    size_t const bits = std::min( w - i * 64, size_t( 64 ) ) ;
+                    return bits == 64 ? ~uint64_t( 0 ) : (uint64_t( 1 ) << bits) - 1 ;
+                }
+
+                bool_t is_full( size_t const y ) const noexcept
+                {
+                    return fill[y] == w ;
+                }
+
+                // true if any of bits, shifted to column x, is set in row y. 
+                // The bits may straddle two words.
+                bool_t overlaps( size_t const x, size_t const y, uint64_t const bits ) const noexcept
+                {
+                    if( x >= w || y >= h ) return false ;
+
+                    auto const r = this_t::row( y ) ;
+                    size_t const i = x >> 6 ;
+                    size_t const s = x & 63 ;
+
+                    if( (r[i] & (bits << s)) != 0 ) return true ;
+                    return s != 0 && i + 1 < words && (r[i+1] & (bits >> (64 - s))) != 0 ;
+                }
+
+                // sets bits, shifted to column x, in row y. Bits outside the 
+                // board are dropped.
+                void_t set( size_t const x, size_t const y, uint64_t const bits ) noexcept
+                {
+                    if( x >= w || y >= h ) return ;
+
+                    auto r = this_t::row( y ) ;
+                    size_t const i = x >> 6 ;
+                    size_t const s = x & 63 ;
+
+                    uint64_t const lo = (bits << s) & this_t::full_mask( i ) ;
+                    this_t::add_cells( i, y, lo & ~r[i] ) ;
+                    r[i] |= lo ;
+
+                    if( s != 0 && i + 1 < words ) 
+                    {
+                        uint64_t const hi = (bits >> (64 - s)) & this_t::full_mask( i + 1 ) ;
+                        this_t::add_cells( i + 1, y, hi & ~r[i+1] ) ;
+                        r[i+1] |= hi ;
+                    }
+
+                    top = std::max( top, y + 1 ) ;
+                    if( this_t::is_full( y ) ) lowest_full = std::min( lowest_full, y ) ;
+                }
+
+                bool_t get( size_t const x, size_t const y ) const noexcept
+                {
+                    return this_t::overlaps( x, y, 1 ) ;
+                }
+
+                // the pivot row a piece dropped straight down from above lands
+                // on. The piece must be within the walls in column x.
+                int_t drop_row( size_t const piece, size_t const rot, int_t const x ) const noexcept
+                {
+                    auto const & cells = PIECES[piece].cells[rot] ;
+
+                    int_t y = int_t( heights[ size_t( x + cells[0].x ) ] ) - cells[0].y ;
+                    for( size_t i=1; i<PIECES[piece].num_cells; ++i )
+                    {
+                        y = std::max( y, int_t( heights[ size_t( x + cells[i].x ) ] ) - cells[i].y ) ;
+                    }
+                    return y ;
+                }
+
+                // removes the full rows and moves the rows above them down. 
+                // Only the rows from the lowest full row to the top are touched
+                // and every run of kept rows is moved as one block. Returns the
+                // number of cleared rows.
+                size_t clear_full_rows( void_t ) noexcept
+                {
+                    if( lowest_full == size_t( -1 ) ) return 0 ;
+
+                    this_t::touch_rows( lowest_full, top ) ;
+
+                    size_t to = lowest_full ;
+                    size_t y = lowest_full ;
+                    while( y < top )
+                    {
+                        if( this_t::is_full( y ) ) 
+                        {
+                            ++y ;
+                            continue ;
+                        }
+
+                        size_t const from = y ;
+                        while( y < top && !this_t::is_full( y ) ) ++y ;
+
+                        this_t::move_rows( to, from, y - from ) ;
+                        to += y - from ;
+                    }
+
+                    size_t const cleared = top - to ;
+
+                    std::fill( rows.begin() + to * words, rows.begin() + top * words, uint64_t( 0 ) ) ;
+                    std::fill( fill.begin() + to, fill.begin() + top, size_t( 0 ) ) ;
+
+                    top = to ;
+                    lowest_full = size_t( -1 ) ;
+
+                    // the full rows are below the top of every column and have
+                    // no holes. Only a column whose top was cleared needs to 
+                    // walk down to its new top.
+                    for( size_t x=0; x<w; ++x )
+                    {
+                        size_t hgt = heights[x] - cleared ;
+                        while( hgt > 0 && !this_t::get( x, hgt - 1 ) ) 
+                        {
+                            --hgt ;
+                            --holes[x] ;
+                            --total_holes ;
+                        }
+                        heights[x] = hgt ;
+                    }
+
+                    return cleared ;
+                }
+
+                // updates the cell and column counts for the newly set bits 
+                // of word i in row y
+                void_t add_cells( size_t const i, size_t const y, uint64_t bits ) noexcept
+                {
+                    fill[y] += this_t::count_bits( bits ) ;
+
+                    while( bits != 0 )
+                    {
+                        // the lowest bit
+                        size_t const x = i * 64 + this_t::count_bits( (bits & (~bits + 1)) - 1 ) ;
+                        bits &= bits - 1 ;
+
+                        this_t::touch( x, y ) ;
+
+                        if( y >= heights[x] )
+                        {
+                            holes[x] += y - heights[x] ;
+                            total_holes += y - heights[x] ;
+                            heights[x] = y + 1 ;
+                        }
+                        else
+                        {
+                            --holes[x] ;
+                            --total_holes ;
+                        }
+                    }
+                }
+
+                // moves n rows down from row from to row to
+                void_t move_rows( size_t const to, size_t const from, size_t const n ) noexcept
+                {
+                    if( to == from || n == 0 ) return ;
+
+                    std::copy( this_t::row( from ), this_t::row( from ) + n * words, this_t::row( to ) ) ;
+                    std::copy( fill.begin() + from, fill.begin() + from + n, fill.begin() + to ) ;
+                }
             };
             natus_typedef( level ) ;
-            level_t _level ;
+
+            // the level being played. It is built off the callbacks and 
+            // published as a whole so the callbacks never see it half built.
+            // A published level is never changed.
+            typedef versioned_ptr< level_t const > current_level_t ;
+            std::shared_ptr< current_level_t > _level = std::make_shared< current_level_t >() ;
+
+            // the simulation plays on its own copy of the published level. 
+            // Only touched by on_physics.
+            current_level_t::ptr_t _played ;
+            level_t _board ;
+
+            // what on_graphics draws of the board. on_physics copies the 
+            // chunks that changed into it after every step and on_graphics
+            // copies out the visible chunks that changed since it drew them.
+            // shared so the game stays movable.
+            struct board_view
+            {
+                std::mutex mtx ;
+
+                size_t w = 0 ;
+                size_t h = 0 ;
+                size_t chunks_x = 0 ;
+                size_t chunks_y = 0 ;
+
+                // per chunk its revision and CHUNK rows of CHUNK cells. The
+                // revisions only grow so a cache never matches a stale chunk.
+                natus::ntd::vector< size_t > revs ;
+                natus::ntd::vector< uint32_t > bits ;
+                size_t last_rev = 0 ;
+
+                // the falling piece
+                piece_cell base = { 0, 0 } ;
+                size_t shape_elems = 0 ;
+                std::array< piece_cell, 5 > shape ;
+            };
+            natus_typedef( board_view ) ;
+            std::shared_ptr< board_view_t > _view = std::make_shared< board_view_t >() ;
+
+            // the board revisions as of the last copy into the view. Only 
+            // touched by on_physics.
+            natus::ntd::vector< size_t > _view_revs ;
+            size_t _view_last_rev = 0 ;
 
             natus::math::vec2f_t _game_space = natus::math::vec2f_t( 800.0f, 600.0f ) ;
-            natus::math::vec2f_t _dims = natus::math::vec2f_t( _game_space.x() / float_t( _level.w ), _game_space.y() / float_t( _level.h ) ) ;
+            natus::math::vec2f_t _dims = natus::math::vec2f_t( _game_space.x() / float_t( level_t().w ), _game_space.y() / float_t( level_t().h ) ) ;
+
+            // cells are not drawn smaller than this. Boards that do not fit 
+            // the game space scroll with the piece. Below grid_cell the empty 
+            // cells are not drawn one by one.
+            float_t _min_cell = 4.0f ;
+            float_t _grid_cell = 8.0f ;
+
+            // the cells of a view chunk in board pixels as of revision rev.
+            // Only used by on_graphics.
+            struct chunk_cache
+            {
+                size_t rev = 0 ;
+
+                // copied out of the view. The cells are gathered from it 
+                // outside of the view lock.
+                bool_t dirty = false ;
+                std::array< uint32_t, level_t::CHUNK > bits ;
+
+                natus::ntd::vector< natus::math::vec2f_t > set ;
+                natus::ntd::vector< natus::math::vec2f_t > empty ;
+            };
+            natus_typedef( chunk_cache ) ;
+            natus::ntd::vector< chunk_cache_t > _chunk_cache ;
 
             struct brick
             {
@@ -179,111 +556,429 @@ namespace paddle_n_ball
 
             struct player
             {
-                natus::math::vec2f_t adv ;
-                natus::math::vec2f_t adv2 ;
+                natus_this_typedefs( player ) ;
+
+                // speeds in fixed point cells per second. fall is downwards.
+                int64_t fall = 0 ;
+                int64_t slide = 0 ;
 
-                size_t cur_shape = 4 ;
+                // fixed point progress into the next cell
+                int64_t fall_acc = 0 ;
+                int64_t slide_acc = 0 ;
+
+                size_t piece = 0 ;
+                size_t rot = 0 ;
+
+                // the pivot cell and the cells the piece covers
+                piece_cell base = { 0, 0 } ;
                 size_t shape_elems = 0 ;
-                std::array< natus::math::vec2f_t, 5 > shape ;
+                std::array< piece_cell, 5 > shape ;
 
-                // 0 : L 0 x cw
-                // 1 : L 1 x cw
-                // 2 : L 2 x cw
-                // 3 : L 3 x cw
-                // 4 : rect
-                // 5 : |
-                // 6 : -
-                void_t set_shape( size_t const s, natus::math::vec2f_t pos, natus::math::vec2f_t dims ) noexcept
+                void_t place( piece_cell const b ) noexcept
                 {
-                    cur_shape = s ;
+                    auto const & p = PIECES[piece] ;
 
-                    if( s == 0 )
+                    base = b ;
+                    shape_elems = p.num_cells ;
+                    for( size_t i=0; i<p.num_cells; ++i )
                     {
-                        shape_elems = 5 ;
-                        shape[0] = pos + dims * natus::math::vec2f_t( 0.0f, 0.0f ) ;
-                        shape[1] = pos + dims * natus::math::vec2f_t( 1.0f, 0.0f ) ;
-                        shape[2] = pos + dims * natus::math::vec2f_t( 0.0f, 1.0f ) ;
-                        shape[3] = pos + dims * natus::math::vec2f_t( 0.0f, 2.0f ) ;
-                        shape[4] = pos + dims * natus::math::vec2f_t( 0.0f, 3.0f ) ;
+                        shape[i] = { b.x + p.cells[rot][i].x, b.y + p.cells[rot][i].y } ;
                     }
-                    else if( s == 1 )
+                }
+
+                void_t next_piece( void_t ) noexcept
+                {
+                    piece = (piece + 1) % NUM_PIECES ;
+                    rot = 0 ;
+                    fall_acc = 0 ;
+                    slide_acc = 0 ;
+                }
+
+                // true if the piece in rotation r with its pivot at b is 
+                // within the walls and does not overlap the level
+                bool_t fits( level_cref_t lvl, size_t const r, piece_cell const b ) const noexcept
+                {
+                    auto const & p = PIECES[piece] ;
+
+                    for( size_t i=0; i<p.num_cells; ++i )
                     {
-                        shape_elems = 5 ;
-                        shape[0] = pos + dims * natus::math::vec2f_t( 0.0f, 0.0f ) ;
-                        shape[1] = pos + dims * natus::math::vec2f_t( 0.0f, -1.0f ) ;
-                        shape[2] = pos + dims * natus::math::vec2f_t( 1.0f, 0.0f ) ;
-                        shape[3] = pos + dims * natus::math::vec2f_t( 2.0f, 0.0f ) ;
-                        shape[4] = pos + dims * natus::math::vec2f_t( 3.0f, 0.0f ) ;
+                        int_t const x = b.x + p.cells[r][i].x ;
+                        int_t const y = b.y + p.cells[r][i].y ;
+
+                        if( x < 0 || x >= int_t( lvl.w ) || y < 0 ) return false ;
+                        if( lvl.overlaps( size_t( x ), size_t( y ), 1 ) ) return false ;
                     }
-                    else if( s == 2 )
+                    return true ;
+                }
+
+                // moves the piece by one cell if it fits there
+                bool_t shift( level_cref_t lvl, int_t const dx, int_t const dy ) noexcept
+                {
+                    piece_cell const b = { base.x + dx, base.y + dy } ;
+                    if( !this_t::fits( lvl, rot, b ) ) return false ;
+
+                    this_t::place( b ) ;
+                    return true ;
+                }
+
+                // rotates ccw for lr == 0, cw otherwise. The first kick that 
+                // fits is taken. Returns false if none fits.
+                bool_t rotate( size_t const lr, level_cref_t lvl ) noexcept
+                {
+                    size_t const r = (rot + (lr == 0 ? NUM_ROTATIONS - 1 : 1)) % NUM_ROTATIONS ;
+
+                    for( auto const & k : KICKS )
                     {
-                        shape_elems = 5 ;
-                        shape[0] = pos + dims * natus::math::vec2f_t( 0.0f, 0.0f ) ;
-                        shape[1] = pos + dims * natus::math::vec2f_t( -1.0f, 0.0f ) ;
-                        shape[2] = pos + dims * natus::math::vec2f_t( 0.0f, -1.0f ) ;
-                        shape[3] = pos + dims * natus::math::vec2f_t( 0.0f, -2.0f ) ;
-                        shape[4] = pos + dims * natus::math::vec2f_t( 0.0f, -3.0f ) ;
+                        piece_cell const b = { base.x + k.x, base.y + k.y } ;
+                        if( !this_t::fits( lvl, r, b ) ) continue ;
+
+                        rot = r ;
+                        this_t::place( b ) ;
+                        return true ;
                     }
-                    else if( s == 3 )
+                    return false ;
+                }
+            } ;
+            natus_typedefs( entity< player >, player ) ;
+            
+            player_t _player ;
+
+        public: // bot
+
+            // where the bot puts a piece. x and y are the pivot cell.
+            struct placement
+            {
+                bool_t valid = false ;
+                size_t rot = 0 ;
+                int_t x = 0 ;
+                int_t y = 0 ;
+                float_t score = -std::numeric_limits< float_t >::max() ;
+            };
+            natus_typedef( placement ) ;
+
+        private:
+
+            // the bot steers the piece and ignores the input
+            bool_t _bot = false ;
+
+            // false until the bot placed the current piece
+            bool_t _bot_moved = false ;
+
+            // placements evaluated per task
+            size_t _bot_grain = 16 ;
+
+            // the bot searches 4 x w placements per piece in on_physics so it
+            // is turned off on wider boards
+            size_t _bot_max_w = 1024 ;
+
+        public:
+
+            void_t set_bot( bool_t const b ) noexcept { _bot = b ; }
+
+            // sets the cells of pl in lvl and returns the number of cleared rows
+            static size_t lock_cells( level_ref_t lvl, player const & pl ) noexcept
+            {
+                for( size_t i=0; i<pl.shape_elems; ++i )
+                {
+                    auto const cell = pl.shape[i] ;
+                    lvl.set( size_t( cell.x ), size_t( cell.y ), 1 ) ;
+                }
+                return lvl.clear_full_rows() ;
+            }
+
+            // the column sums of a level the score needs. Taken once per 
+            // placement search and updated per candidate.
+            struct level_stats
+            {
+                size_t height = 0 ;
+                size_t bumps = 0 ;
+            };
+            natus_typedef( level_stats ) ;
+
+            static level_stats stats_of( level_cref_t lvl ) noexcept
+            {
+                level_stats ret ;
+
+                for( size_t x=0; x<lvl.w; ++x )
+                {
+                    size_t const col = lvl.heights[x] ;
+                    ret.height += col ;
+
+                    if( x == 0 ) continue ;
+
+                    size_t const prev = lvl.heights[x-1] ;
+                    ret.bumps += col > prev ? col - prev : prev - col ;
+                }
+
+                return ret ;
+            }
+
+            // weights the board like the usual tetris bots do. Higher is better.
+            static float_t score_level( size_t const height, size_t const cleared, size_t const holes, 
+                size_t const bumps ) noexcept
+            {
+                return -0.51f * float_t( height ) + 0.76f * float_t( cleared ) - 
+                    0.36f * float_t( holes ) - 0.18f * float_t( bumps ) ;
+            }
+
+            // drops the piece in rotation rot and pivot column x from above 
+            // the level and scores the board it would leave. The level is not
+            // changed. Only the columns and rows the piece covers are looked 
+            // at unless the piece clears rows. Pieces that do not fit or 
+            // stick out at the top are not valid.
+            static placement evaluate( level_cref_t lvl, level_stats_cref_t st, size_t const piece, 
+                size_t const rot, int_t const x ) noexcept
+            {
+                placement ret ;
+                ret.rot = rot ;
+                ret.x = x ;
+
+                player pl ;
+                pl.piece = piece ;
+                pl.rot = rot ;
+
+                // above the level only the walls are tested
+                if( !pl.fits( lvl, rot, { x, int_t( lvl.h ) + 4 } ) ) return ret ;
+
+                piece_cell const b = { x, lvl.drop_row( piece, rot, x ) } ;
+
+                pl.place( b ) ;
+                for( size_t i=0; i<pl.shape_elems; ++i )
+                {
+                    if( pl.shape[i].y >= int_t( lvl.h ) ) return ret ;
+                }
+
+                // the covered columns. The piece rests on the column tops so
+                // it never fills a hole.
+                size_t x0 = size_t( pl.shape[0].x ) ;
+                size_t x1 = x0 ;
+                for( size_t i=1; i<pl.shape_elems; ++i )
+                {
+                    x0 = std::min( x0, size_t( pl.shape[i].x ) ) ;
+                    x1 = std::max( x1, size_t( pl.shape[i].x ) ) ;
+                }
+
+                std::array< size_t, 5 > hgt ;
+                std::array< size_t, 5 > cells ;
+                for( size_t c=0; c<=x1-x0; ++c )
+                {
+                    hgt[c] = lvl.heights[x0+c] ;
+                    cells[c] = 0 ;
+                }
+
+                for( size_t i=0; i<pl.shape_elems; ++i )
+                {
+                    size_t const c = size_t( pl.shape[i].x ) - x0 ;
+                    hgt[c] = std::max( hgt[c], size_t( pl.shape[i].y ) + 1 ) ;
+                    ++cells[c] ;
+                }
+
+                size_t holes = lvl.total_holes ;
+                for( size_t c=0; c<=x1-x0; ++c )
+                {
+                    holes += hgt[c] - lvl.heights[x0+c] - cells[c] ;
+                }
+
+                // the rows the piece fills up
+                std::array< size_t, 5 > full ;
+                size_t cleared = 0 ;
+                for( size_t i=0; i<pl.shape_elems; ++i )
+                {
+                    int_t const y = pl.shape[i].y ;
+
+                    size_t n = 0 ;
+                    bool_t seen = false ;
+                    for( size_t j=0; j<pl.shape_elems; ++j )
                     {
-                        shape_elems = 5 ;
-                        shape[0] = pos + dims * natus::math::vec2f_t( 0.0f, 0.0f ) ;
-                        shape[1] = pos + dims * natus::math::vec2f_t( 0.0f, 1.0f ) ;
-                        shape[2] = pos + dims * natus::math::vec2f_t( -1.0f, 0.0f ) ;
-                        shape[3] = pos + dims * natus::math::vec2f_t( -2.0f, 0.0f ) ;
-                        shape[4] = pos + dims * natus::math::vec2f_t( -3.0f, 0.0f ) ;
+                        if( pl.shape[j].y != y ) continue ;
+                        seen = seen || j < i ;
+                        ++n ;
                     }
-                    else if( s == 4 )
+
+                    if( !seen && lvl.fill[ size_t( y ) ] + n == lvl.w ) full[cleared++] = size_t( y ) ;
+                }
+                std::sort( full.begin(), full.begin() + cleared ) ;
+
+                auto const height_at = [&]( size_t const col )
+                {
+                    return col >= x0 && col <= x1 ? hgt[col-x0] : lvl.heights[col] ;
+                } ;
+
+                ret.valid = true ;
+                ret.y = b.y ;
+
+                if( cleared == 0 )
+                {
+                    size_t height = st.height ;
+                    for( size_t c=0; c<=x1-x0; ++c ) height += hgt[c] - lvl.heights[x0+c] ;
+
+                    // only the column pairs next to the piece change
+                    size_t bumps = st.bumps ;
+                    for( size_t col=std::max( x0, size_t( 1 ) ); col<=std::min( x1 + 1, lvl.w - 1 ); ++col )
                     {
-                        shape_elems = 4 ;
-                        shape[0] = pos + dims * natus::math::vec2f_t( 0.0f, 0.0f ) ;
-                        shape[1] = pos + dims * natus::math::vec2f_t( 0.0f, 1.0f ) ;
-                        shape[2] = pos + dims * natus::math::vec2f_t( 1.0f, 0.0f ) ;
-                        shape[3] = pos + dims * natus::math::vec2f_t( 1.0f, 1.0f ) ;
+                        size_t const a0 = lvl.heights[col-1] ;
+                        size_t const b0 = lvl.heights[col] ;
+                        size_t const a1 = height_at( col-1 ) ;
+                        size_t const b1 = height_at( col ) ;
+
+                        bumps -= a0 > b0 ? a0 - b0 : b0 - a0 ;
+                        bumps += a1 > b1 ? a1 - b1 : b1 - a1 ;
                     }
-                    else if( s == 5 )
+
+                    ret.score = this_t::score_level( height, 0, holes, bumps ) ;
+                    return ret ;
+                }
+
+                // true if the cell is set after the piece is locked and the 
+                // full rows are cleared
+                auto const is_set = [&]( size_t const col, size_t const r )
+                {
+                    size_t y = r ;
+                    for( size_t i=0; i<cleared; ++i ) if( full[i] <= y ) ++y ;
+
+                    if( lvl.get( col, y ) ) return true ;
+                    for( size_t i=0; i<pl.shape_elems; ++i )
                     {
-                        shape_elems = 4 ;
-                        shape[0] = pos + dims * natus::math::vec2f_t( 0.0f, 0.0f ) ;
-                        shape[1] = pos + dims * natus::math::vec2f_t( 0.0f, 1.0f ) ;
-                        shape[2] = pos + dims * natus::math::vec2f_t( 0.0f, 2.0f ) ;
-                        shape[3] = pos + dims * natus::math::vec2f_t( 0.0f, 3.0f ) ;
+                        if( size_t( pl.shape[i].x ) == col && size_t( pl.shape[i].y ) == y ) return true ;
                     }
-                    else if( s == 6 )
+                    return false ;
+                } ;
+
+                // every column drops by the cleared rows and one whose top was
+                // cleared walks down to its new top like clear_full_rows does
+                size_t height = 0 ;
+                size_t bumps = 0 ;
+                size_t prev = 0 ;
+                for( size_t col=0; col<lvl.w; ++col )
+                {
+                    size_t h = height_at( col ) - cleared ;
+                    while( h > 0 && !is_set( col, h - 1 ) ) 
                     {
-                        shape_elems = 4 ;
-                        shape[0] = pos + dims * natus::math::vec2f_t( 0.0f, 0.0f ) ;
-                        shape[1] = pos + dims * natus::math::vec2f_t( 1.0f, 0.0f ) ;
-                        shape[2] = pos + dims * natus::math::vec2f_t( 2.0f, 0.0f ) ;
-                        shape[3] = pos + dims * natus::math::vec2f_t( 3.0f, 0.0f ) ;
+                        --h ;
+                        --holes ;
                     }
+
+                    height += h ;
+                    if( col > 0 ) bumps += h > prev ? h - prev : prev - h ;
+                    prev = h ;
                 }
 
-                void_t rotate( size_t const lr ) noexcept
+                ret.score = this_t::score_level( height, cleared, holes, bumps ) ;
+
+                return ret ;
+            }
+
+            // evaluates every rotation x column of the piece. Candidates are
+            // split over tasks by grain, 0 evaluates all on the caller.
+            static placement find_placement( level_cref_t lvl, size_t const piece, size_t const grain ) noexcept
+            {
+                size_t const n = NUM_ROTATIONS * lvl.w ;
+                level_stats const st = this_t::stats_of( lvl ) ;
+
+                auto const best_of = [&]( size_t const b, size_t const e )
                 {
-                    if( cur_shape <= 3 )
+                    placement best ;
+                    for( size_t i=b; i<e; ++i )
                     {
-                        cur_shape += lr == 0 ? -1 : 1 ;
-                        cur_shape %= 7 ;
+                        auto const p = this_t::evaluate( lvl, st, piece, i % NUM_ROTATIONS, int_t( i / NUM_ROTATIONS ) ) ;
+                        if( p.valid && p.score > best.score ) best = p ;
                     }
-                }
-            } ;
-            natus_typedefs( entity< player >, player ) ;
-            
-            player_t _player ;
+                    return best ;
+                } ;
+
+                if( grain == 0 ) return best_of( 0, n ) ;
+
+                std::mutex mtx ;
+                placement best ;
+
+                parallel_for( n, grain, [&]( size_t const b, size_t const e )
+                {
+                    auto const p = best_of( b, e ) ;
+
+                    std::lock_guard< std::mutex > lk( mtx ) ;
+                    if( p.valid && p.score > best.score ) best = p ;
+                } ) ;
+
+                return best ;
+            }
+
+            // plays games headless with the bot, spread over tasks one game 
+            // each, and logs the throughput. A game ends if a piece does not
+            // fit anymore or after max_pieces.
+            static void_t soak( size_t const games, size_t const w, size_t const h, size_t const max_pieces ) noexcept
+            {
+                std::atomic< size_t > rows { 0 } ;
+                std::atomic< size_t > pieces { 0 } ;
+
+                auto const tp = clock_t::now() ;
+
+                parallel_for( games, 1, [&]( size_t const b, size_t const e )
+                {
+                    level_t lvl ;
+                    for( size_t g=b; g<e; ++g )
+                    {
+                        lvl.resize( w, h ) ;
+
+                        player pl ;
+                        pl.piece = g % NUM_PIECES ;
+
+                        size_t n = 0 ;
+                        for( ; n<max_pieces; ++n )
+                        {
+                            auto const p = this_t::find_placement( lvl, pl.piece, 0 ) ;
+                            if( !p.valid ) break ;
+
+                            pl.rot = p.rot ;
+                            pl.place( { p.x, p.y } ) ;
+                            rows += this_t::lock_cells( lvl, pl ) ;
+                            pl.next_piece() ;
+                        }
+                        pieces += n ;
+                    }
+                } ) ;
+
+                size_t const ms = std::max( size_t( std::chrono::duration_cast< std::chrono::milliseconds >( 
+                    clock_t::now() - tp ).count() ), size_t( 1 ) ) ;
+
+                natus::log::global_t::status( "[soak] : " + std::to_string( games ) + " games on " + 
+                    std::to_string( w ) + "x" + std::to_string( h ) + " in " + std::to_string( ms ) + " ms, " + 
+                    std::to_string( games * 1000 / ms ) + " games/s, " + 
+                    std::to_string( pieces / std::max( games, size_t( 1 ) ) ) + " pieces and " + 
+                    std::to_string( rows / std::max( games, size_t( 1 ) ) ) + " rows per game" ) ;
+            }
+
+        private:
+
+            // puts the fresh piece where the bot wants it and drops it fast
+            void_t bot_place( level_cref_t lvl ) noexcept
+            {
+                _bot_moved = true ;
+
+                auto & p = _player.comp ;
+                auto const best = this_t::find_placement( lvl, p.piece, _bot_grain ) ;
+                if( !best.valid ) return ;
+
+                piece_cell const b = { best.x, p.base.y } ;
+                if( !p.fits( lvl, best.rot, b ) ) return ;
+
+                p.rot = best.rot ;
+                p.place( b ) ;
+                p.slide = 0 ;
+                p.fall = _gravity + _drop_speed ;
+            }
 
             
             size_t _next_shape = 0 ;
 
-        private: // audio
+        private: // input
 
-            struct audio_queue_item
-            {
-                natus::audio::buffer_object_res_t buffer ;
-                natus::audio::execution_options eo ;
-                bool_t loop = false ;
-            } ;
-            natus::ntd::vector< audio_queue_item > _audio_play_queue ;
+            // pushed by on_device, applied at the start of a physics step
+            enum class input { move, rotate_a, rotate_b, drop } ;
+            typedef input_queue< input > inputs_t ;
+            std::shared_ptr< inputs_t > _input = std::make_shared< inputs_t >() ;
+
+            // the last movement pushed. only used by on_device.
+            natus::math::vec2f_t _input_move ;
 
         private: // score
 
@@ -291,7 +986,6 @@ namespace paddle_n_ball
 
         private:
 
-            bool_t _is_init = false ;
             size_t _level_cur = 0 ;
             size_t _level_max = 4 ;
 
@@ -299,12 +993,33 @@ namespace paddle_n_ball
 
             size_t get_score( void_t ) const noexcept { return _score ; }
 
+        private:
+
+            // one cell in fixed point
+            static constexpr int64_t FIXED_ONE = int64_t( 1 ) << 16 ;
+
+            // in fixed point cells per second
+            int64_t _gravity = 20 * FIXED_ONE ;
+            int64_t _slide_speed = 10 * FIXED_ONE ;
+            int64_t _drop_speed = 20 * FIXED_ONE ;
+
+            // new pieces start right above the level
+            piece_cell spawn_cell( level_cref_t lvl ) const noexcept
+            {
+                return { int_t( lvl.w / 4 ), int_t( lvl.h ) } ;
+            }
+
         public:
 
             struct init_data
             {
                 natus::io::database_res_t db ;
                 natus::audio::async_access_t audio ;
+                startup_trace_ptr_t trace ;
+
+                // in cells
+                size_t board_w = 40 ;
+                size_t board_h = 60 ;
             };
             natus_typedef( init_data ) ;
             init_data _init_data ;
@@ -314,22 +1029,34 @@ namespace paddle_n_ball
             {
                 _init_data = std::move( d ) ;
 
-                natus::concurrent::task_res_t root = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
+                if( _bot && _init_data.board_w > _bot_max_w )
                 {
-                    _player.pos = natus::math::vec2f_t( 0.0f, 600.0f ) ;
-                    _player.comp.adv = natus::math::vec2f_t( 0.0f, -200.0f ) ;
-                    _player.comp.set_shape( _player.comp.cur_shape, _player.pos, _dims ) ;
+                    natus::log::global_t::warning( "[bot] : boards wider than " + std::to_string( _bot_max_w ) + 
+                        " cells are not played by the bot" ) ;
+                    _bot = false ;
+                }
 
-                    _level.layout.resize( _level.w * _level.h ) ;
-                    for( auto & i : _level.layout )
-                    {
-                        i = 0 ;
-                    }
+                auto lvl = std::make_shared< level_t >() ;
+                size_t const version = _level->issue() ;
+
+                natus::concurrent::task_res_t root = natus::concurrent::task_t( [&, lvl]( natus::concurrent::task_res_t )
+                {
+                    lvl->resize( _init_data.board_w, _init_data.board_h ) ;
+
+                    natus::math::vec2f_t const fit = _game_space / natus::math::vec2f_t( float_t( lvl->w ), float_t( lvl->h ) ) ;
+                    _dims = natus::math::vec2f_t( std::max( fit.x(), _min_cell ), std::max( fit.y(), _min_cell ) ) ;
+
+                    _player.comp.fall = _gravity ;
+                    _player.comp.place( this_t::spawn_cell( *lvl ) ) ;
                 }) ;
 
-                natus::concurrent::task_res_t finish = natus::concurrent::task_t([&]( natus::concurrent::task_res_t )
+                // closed when all init tasks are done
+                size_t const ph = _init_data.trace->begin( "game init" ) ;
+
+                natus::concurrent::task_res_t finish = natus::concurrent::task_t([&, lvl, version, ph]( natus::concurrent::task_res_t )
                 {
-                    _is_init = true ;
+                    _level->publish( lvl, version ) ;
+                    _init_data.trace->end( ph ) ;
                 } ) ;
 
                 root->then( finish ) ;
@@ -340,245 +1067,265 @@ namespace paddle_n_ball
             //********************************************************************************
             void_t on_update( void_t ) noexcept
             {
-                if( !_is_init ) return ;
+                if( _level->load() == nullptr ) return ;
                 //auto const dt = std::chrono::milliseconds( milli_dt ) ;
             }
 
             //********************************************************************************
             void_t on_device( natus::device::ascii_device_res_t keyboard, natus::device::game_device_res_t dev ) noexcept
             {
-                if( !_is_init ) return ;
+                if( _level->load() == nullptr ) return ;
 
                 // move paddle
                 {
                     using ctrl_t = natus::device::layouts::game_controller_t ;
                     ctrl_t ctrl( dev ) ;
 
+                    // only changes are pushed
+                    auto const move = [&]( natus::math::vec2f_t const & v )
+                    {
+                        if( v.x() == _input_move.x() && v.y() == _input_move.y() ) return ;
+                        if( _input->push( input::move, v ) ) _input_move = v ;
+                    } ;
+
                     natus::math::vec2f_t value ;
                     if( ctrl.is( ctrl_t::directional::movement, natus::device::components::stick_state::tilting, value ) )
                     {
-                        _player.comp.adv2 = natus::math::vec2f_t(200.0f) * value ;
+                        move( value ) ;
                     }
                     else if( ctrl.is( ctrl_t::directional::movement, natus::device::components::stick_state::untilted, value ) )
                     {
-                       _player.comp.adv2 = natus::math::vec2f_t( 0.0f, 0.0f ) ;
+                        move( natus::math::vec2f_t( 0.0f, 0.0f ) ) ;
                     }
 
                     float_t button_value ;
                     if( ctrl.is( ctrl_t::button::action_a, natus::device::components::button_state::released, button_value ) )
                     {
-                        _player.comp.rotate( 0 ) ;
+                        _input->push( input::rotate_a ) ;
                     }
                     else if( ctrl.is( ctrl_t::button::action_b, natus::device::components::button_state::released, button_value ) )
                     {
-                        _player.comp.rotate( 1 ) ;
+                        _input->push( input::rotate_b ) ;
+                    }
+                }
+
+                // hard drop
+                {
+                    natus::device::layouts::ascii_keyboard_t ascii( keyboard ) ;
+                    if( ascii.get_state( natus::device::layouts::ascii_keyboard_t::ascii_key::space ) ==
+                        natus::device::components::key_state::released )
+                    {
+                        _input->push( input::drop ) ;
                     }
                 }
             }
 
             //********************************************************************************
-            void_t on_logic( size_t const milli_dt ) noexcept 
+            // applies the input pushed since the last physics step
+            void_t apply_input( level_ref_t lvl ) noexcept
             {
-                if( !_is_init ) return ;
-
-                for( size_t y=0; y<_level.h; ++y )
+                _input->consume( [&]( inputs_t::event_cref_t e )
                 {
-                    size_t c = 0 ;
-                    for( size_t x=0; x<_level.w; ++x )
-                    {
-                        if( _level.layout[ y * _level.w + x ] == 0 ) break ;
-                        ++c ;
-                    }
+                    if( _bot ) return ;
 
-                    // clear row
-                    if( c == _level.w ) 
+                    switch( e.what )
                     {
-                        size_t y1 = y ;
-                        for( size_t y2=y+1; y2<_level.h-1; ++y2, ++y1 )
-                        {
-                            for( size_t x=0; x<_level.w; ++x )
-                            {
-                                _level.layout[ y1 * _level.w + x ] = 
-                                    _level.layout[ y2 * _level.w + x ] ;
-                            }
-                        }
+                    case input::move: 
+                        _player.comp.slide = int64_t( e.value.x() * float_t( _slide_speed ) ) ;
+                        _player.comp.fall = _gravity + std::max( int64_t( -e.value.y() * float_t( _drop_speed ) ), -_gravity ) ;
+                        break ;
+
+                    case input::rotate_a: 
+                        _player.comp.rotate( 0, lvl ) ;
+                        break ;
+
+                    case input::rotate_b: 
+                        _player.comp.rotate( 1, lvl ) ;
+                        break ;
+
+                    case input::drop: 
+                        this_t::hard_drop( lvl ) ;
+                        break ;
                     }
-                }
+                } ) ;
             }
 
             //********************************************************************************
-            void_t on_physics( size_t const milli_dt ) noexcept
+            void_t on_logic( size_t const milli_dt ) noexcept 
             {
-                if( !_is_init ) return ;
+                auto const cur = _level->load() ;
+                if( cur == nullptr ) return ;
 
-                float_t const dt = (float_t(milli_dt) / 1000.0f) ;
-                
-                player_t next ;
-                next.pos = _player.pos ;
-                next.comp.adv = _player.comp.adv ;
-                next.comp.adv2 = _player.comp.adv2 ;
+                // full rows are cleared when a piece locks in on_physics
+            }
 
-                // advance player
-                {
-                    next.pos += (next.comp.adv + next.comp.adv2) * dt ;
+            //********************************************************************************
+            // one fixed physics step. The piece moves in whole cells and is 
+            // only tested against the level when it crosses into a new cell.
+            void_t on_physics( size_t const micro_dt ) noexcept
+            {
+                auto const cur = this_t::sync_level() ;
+                if( cur == nullptr ) return ;
 
-                    natus::math::vec2f_t const pcell = (next.pos / _dims).floored() ;
-                    natus::math::vec2f_t const pos = pcell * _dims ;
-                    next.comp.set_shape( _player.comp.cur_shape, pos, _dims ) ; 
-                }
-                
-                // collision left right bottom
-                {
-                    natus::math::vec2f_t side_ground( 1.0f ) ;
+                auto & lvl = *cur ;
 
-                    for( size_t i=0; i<next.comp.shape_elems; ++i )
-                    {
-                        auto const p = next.comp.shape[i] ;
+                this_t::apply_input( lvl ) ;
+                if( _bot && !_bot_moved ) this_t::bot_place( lvl ) ;
 
-                        natus::math::vec2f_t const cell = (p / _dims).floored() ;
-                    
-                        if( cell.x() < 0.0f || cell.x() >= float_t(_level.w) )
-                        {
-                            side_ground.x( 0.0f ) ;
-                        }
+                auto & p = _player.comp ;
 
-                        if( cell.y() < 0.0f )
-                        {
-                            side_ground.y( 0.0f ) ;
-                        }
-                    }
+                p.slide_acc += p.slide * int64_t( micro_dt ) / 1000000 ;
+                p.fall_acc += p.fall * int64_t( micro_dt ) / 1000000 ;
 
-                    // do correction
-                    {
-                        next.comp.adv *= side_ground ;
-                        next.comp.adv2 *= side_ground ;
-                        auto const adv = next.comp.adv + next.comp.adv2 ;
-                        next.pos = _player.pos + adv * dt ;
-                        next.comp.set_shape( _player.comp.cur_shape, next.pos, _dims ) ;
-                    }
+                // sideways. a blocked piece loses its progress.
+                while( p.slide_acc >= FIXED_ONE || p.slide_acc <= -FIXED_ONE )
+                {
+                    int_t const dx = p.slide_acc > 0 ? 1 : -1 ;
+                    p.slide_acc -= dx * FIXED_ONE ;
 
-                    if( side_ground.y() < 0.5f )
+                    if( !p.shift( lvl, dx, 0 ) ) 
                     {
-                        for( size_t i=0; i<next.comp.shape_elems; ++i )
-                        {
-                            auto const p = next.comp.shape[i] ;
-
-                            natus::math::vec2f_t const cell = (p / _dims).floored() ;
-                            size_t const x = size_t( cell.x() ) ;
-                            size_t const y = size_t( cell.y() ) ;
-                            _level.layout[ y * _level.w + x ] = 1 ;
-                        }
-                        
-                        _player.pos = natus::math::vec2f_t( 200.0f, 600.0f ) ;
-                        _player.comp.set_shape( ++_player.comp.cur_shape%5, _player.pos, _dims ) ;
-                        return ;
+                        p.slide_acc = 0 ;
+                        break ;
                     }
                 }
 
-                // test against the grid cells
+                // down. a blocked piece is locked.
+                while( p.fall_acc >= FIXED_ONE )
                 {
-                    natus::math::vec2f_t side_ground( 1.0f ) ;
+                    p.fall_acc -= FIXED_ONE ;
+                    if( p.shift( lvl, 0, -1 ) ) continue ;
 
-                    // test side in grid
-                    {
-                        for( size_t i=0; i<next.comp.shape_elems; ++i )
-                        {
-                            auto const p = next.comp.shape[i] ;
+                    this_t::lock_piece( lvl ) ;
+                    break ;
+                }
 
-                            natus::math::vec2f_t const cell = (p/ _dims).floored() ;
-                            size_t const x = size_t( cell.x() ) ;
-                            size_t const y = size_t( cell.y() ) ;
-                        
-                            if( y >= _level.h ) continue ;
+                this_t::publish_view() ;
+            }
 
-                            if( _level.layout[y * _level.w + x] != 0 )
-                            {
-                                side_ground.x( 0.0f ) ;
-                                break ;
-                            }
-                        }
+            //********************************************************************************
+            // takes over a newly published level. Returns the board being 
+            // played or nullptr if no level was published yet.
+            level_t * sync_level( void_t ) noexcept
+            {
+                auto cur = _level->load() ;
+                if( cur != _played )
+                {
+                    _board = cur != nullptr ? *cur : level_t() ;
+                    _played = std::move( cur ) ;
 
-                        // do correction
-                        {
-                            next.comp.adv *= side_ground ;
-                            next.comp.adv2 *= side_ground ;
-                            auto const adv = next.comp.adv + next.comp.adv2 ;
-                            next.pos = _player.pos + adv * dt ;
-                            next.comp.set_shape( _player.comp.cur_shape, next.pos, _dims ) ;
-                        }
-                    }
+                    // the view is copied as a whole
+                    _view_revs.clear() ;
+                }
+                return _played != nullptr ? &_board : nullptr ;
+            }
 
-                    // test hit in grid
-                    {
-                        for( size_t i=0; i<next.comp.shape_elems; ++i )
-                        {
-                            auto const p = next.comp.shape[i] ;
+            //********************************************************************************
+            // copies the chunks of the board that changed since the last call
+            // and the piece into the view
+            void_t publish_view( void_t ) noexcept
+            {
+                static_assert( level_t::CHUNK == 32, "a chunk row is copied as one 32 bit word" ) ;
 
-                            natus::math::vec2f_t const cell = (p/ _dims).floored() ;
-                            size_t const x = size_t( cell.x() ) ;
-                            size_t const y = size_t( cell.y() ) ;
-                        
-                            if( y >= _level.h ) continue ;
+                auto const & b = _board ;
+                auto & v = *_view ;
+                size_t const cs = level_t::CHUNK ;
 
-                            if( _level.layout[y * _level.w + x] != 0 )
-                            {
-                                side_ground.y( 0.0f ) ;
-                                break ;
-                            }
-                        }
+                std::lock_guard< std::mutex > lk( v.mtx ) ;
 
-                        // do correction
-                        {
-                            next.comp.adv *= side_ground ;
-                            next.comp.adv2 *= side_ground ;
-                            auto const adv = next.comp.adv + next.comp.adv2 ;
-                            next.pos = _player.pos + adv * dt ;
-                            next.comp.set_shape( _player.comp.cur_shape, next.pos, _dims ) ;
-                        }
+                if( _view_revs.size() != b.revs.size() )
+                {
+                    // board revisions start at 1
+                    _view_revs.assign( b.revs.size(), 0 ) ;
+                    _view_last_rev = 0 ;
+
+                    v.w = b.w ;
+                    v.h = b.h ;
+                    v.chunks_x = b.chunks_x ;
+                    v.chunks_y = b.chunks_y ;
+                    v.revs.resize( b.revs.size() ) ;
+                    v.bits.resize( b.revs.size() * cs ) ;
+                }
+
+                if( _view_last_rev != b.last_rev )
+                {
+                    for( size_t c=0; c<b.revs.size(); ++c )
+                    {
+                        if( _view_revs[c] == b.revs[c] ) continue ;
+                        _view_revs[c] = b.revs[c] ;
+                        v.revs[c] = ++v.last_rev ;
+
+                        size_t const x0 = (c % b.chunks_x) * cs ;
+                        size_t const y0 = (c / b.chunks_x) * cs ;
 
-                        if( side_ground.y() < 0.5f )
+                        for( size_t r=0; r<cs; ++r )
                         {
-                            for( size_t i=0; i<next.comp.shape_elems; ++i )
-                            {
-                                auto const p = next.comp.shape[i] ;
-                                natus::math::vec2f_t const cell = (p / _dims).floored() ;
-                                size_t const x = size_t( cell.x() ) ;
-                                size_t const y = size_t( cell.y() ) ;
-                                _level.layout[ y * _level.w + x ] = 1 ;
-                            }
-                        
-                            _player.pos = natus::math::vec2f_t( 200.0f, 600.0f ) ;
-                            _player.comp.set_shape( ++_player.comp.cur_shape%5, _player.pos, _dims ) ;
-                            return ;
+                            v.bits[ c * cs + r ] = y0 + r < b.h ? 
+                                uint32_t( b.row( y0 + r )[ x0 >> 6 ] >> (x0 & 63) ) : 0 ;
                         }
                     }
+                    _view_last_rev = b.last_rev ;
                 }
 
-                {
-                    _player.pos = next.pos ;
-                    _player.comp.set_shape( _player.comp.cur_shape, _player.pos, _dims ) ;
-                }
+                v.base = _player.comp.base ;
+                v.shape_elems = _player.comp.shape_elems ;
+                v.shape = _player.comp.shape ;
+            }
+
+            //********************************************************************************
+            // drops the piece to where it lands and locks it. If it is below
+            // the top of any of its columns it is stepped down instead.
+            void_t hard_drop( level_ref_t lvl ) noexcept
+            {
+                auto & p = _player.comp ;
+
+                int_t const y = lvl.drop_row( p.piece, p.rot, p.base.x ) ;
+                if( y <= p.base.y ) p.place( { p.base.x, y } ) ;
+                else while( p.shift( lvl, 0, -1 ) ) {}
+
+                this_t::lock_piece( lvl ) ;
             }
 
             //********************************************************************************
-            void_t on_audio( natus::audio::async_access_t audio ) noexcept
+            // writes the piece into the level and spawns the next one. A 
+            // piece that sticks out at the top ends the game and the level
+            // starts over.
+            void_t lock_piece( level_ref_t lvl ) noexcept
             {
-                for( auto & b : _audio_play_queue )
+                bool_t over = false ;
+                for( size_t i=0; i<_player.comp.shape_elems; ++i )
+                {
+                    over = over || _player.comp.shape[i].y >= int_t( lvl.h ) ;
+                }
+
+                this_t::lock_cells( lvl, _player.comp ) ;
+
+                if( over )
                 {
-                    natus::audio::backend::execute_detail ed ;
-                    ed.to = b.eo ;
-                    ed.loop = b.loop ;
-                    audio.execute( b.buffer, ed ) ;
+                    natus::log::global_t::status( "[tetrix] : game over" ) ;
+                    lvl.resize( lvl.w, lvl.h ) ;
                 }
-                _audio_play_queue.clear() ;
+
+                _player.comp.next_piece() ;
+                _player.comp.place( this_t::spawn_cell( lvl ) ) ;
+                _bot_moved = false ;
             }
 
             //********************************************************************************
             void_t on_graphics( natus::gfx::primitive_render_2d_res_t pr, size_t const milli_dt ) noexcept
             {
-                if( !_is_init ) return ;
-                
-                
+                if( _level->load() == nullptr ) return ;
+
+                auto & v = *_view ;
+                std::unique_lock< std::mutex > lk( v.mtx ) ;
+
+                if( v.w == 0 ) return ;
+
+                // the piece is drawn after the lock is released
+                piece_cell const base = v.base ;
+                size_t const shape_elems = v.shape_elems ;
+                auto const shape = v.shape ;
+
                 natus::math::vec2f_t const menu_space( 800.0f-_game_space.x(), 600.0f ) ;
 
                 // draw right
@@ -596,10 +1343,25 @@ namespace paddle_n_ball
                     ) ;
                 }
 
-                // draw field
+                // the board pixel at the lower left of the game space. follows the
+                // piece if the board does not fit.
+                natus::math::vec2f_t view( 0.0f ) ;
                 {
-                    natus::math::vec2f_t pos = natus::math::vec2f_t( 800.0f, 600.0f ) * natus::math::vec2f_t( -0.5f ) ;
+                    natus::math::vec2f_t const board = _dims * natus::math::vec2f_t( float_t( v.w ), float_t( v.h ) ) ;
+                    natus::math::vec2f_t const piece = _dims * natus::math::vec2f_t( 
+                        float_t( base.x ) + 0.5f, float_t( base.y ) + 0.5f ) ;
+
+                    if( board.x() > _game_space.x() ) 
+                        view.x( std::min( std::max( piece.x() - _game_space.x() * 0.5f, 0.0f ), board.x() - _game_space.x() ) ) ;
+                    if( board.y() > _game_space.y() ) 
+                        view.y( std::min( std::max( piece.y() - _game_space.y() * 0.5f, 0.0f ), board.y() - _game_space.y() ) ) ;
+                }
 
+                natus::math::vec2f_t const origin = natus::math::vec2f_t( 800.0f, 600.0f ) * natus::math::vec2f_t( -0.5f ) - view ;
+
+                // draw field. chunks off the game space are culled and only 
+                // changed chunks are gathered again.
+                {
                     natus::math::vec4f_t const colors[] = {
                         natus::math::vec4f_t(0.9f, 0.9f, 0.9f, 1.0f),
                         natus::math::vec4f_t(1.0f, 0.0f, .00f, 1.0f)
@@ -610,39 +1372,106 @@ namespace paddle_n_ball
                         natus::math::vec4f_t(0.0f, 0.0f, 0.0f, 1.0f)
                     } ;
 
-                    for( size_t y=0; y<_level.h; ++y )
+                    auto const draw_cell = [&]( size_t const l, natus::math::vec2f_t const & pos, 
+                        natus::math::vec2f_t const & dims, size_t const i )
+                    {
+                        pr->draw_rect( l, 
+                            pos + dims * natus::math::vec2f_t( -0.0f, -0.0f ),
+                            pos + dims * natus::math::vec2f_t( -0.0f, +1.0f ),
+                            pos + dims * natus::math::vec2f_t( +1.0f, +1.0f ),
+                            pos + dims * natus::math::vec2f_t( +1.0f, -0.0f ),
+                            colors[i], borders[i]
+                        ) ;
+                    } ;
+
+                    if( _chunk_cache.size() != v.revs.size() )
+                    {
+                        _chunk_cache.clear() ;
+                        _chunk_cache.resize( v.revs.size() ) ;
+                    }
+
+                    bool_t const grid = _dims.x() >= _grid_cell && _dims.y() >= _grid_cell ;
+                    size_t const cs = level_t::CHUNK ;
+
+                    natus::math::vec2f_t const first = (view / _dims).floored() ;
+                    natus::math::vec2f_t const last = ((view + _game_space) / _dims).floored() + natus::math::vec2f_t( 1.0f ) ;
+
+                    size_t const cx0 = size_t( first.x() ) / cs ;
+                    size_t const cy0 = size_t( first.y() ) / cs ;
+                    size_t const cx1 = std::min( (size_t( last.x() ) + cs - 1) / cs, v.chunks_x ) ;
+                    size_t const cy1 = std::min( (size_t( last.y() ) + cs - 1) / cs, v.chunks_y ) ;
+
+                    size_t const w = v.w ;
+                    size_t const h = v.h ;
+                    size_t const chunks_x = v.chunks_x ;
+
+                    // only the changed visible chunks are copied under the lock
+                    for( size_t cy=cy0; cy<cy1; ++cy )
                     {
-                        for( size_t x=0; x<_level.w; ++x )
+                        for( size_t cx=cx0; cx<cx1; ++cx )
                         {
-                            size_t const i = y * _level.w + x ;
-
-                            pr->draw_rect( 5, 
-                                pos + _dims * natus::math::vec2f_t( -0.0f, -0.0f ),
-                                pos + _dims * natus::math::vec2f_t( -0.0f, +1.0f ),
-                                pos + _dims * natus::math::vec2f_t( +1.0f, +1.0f ),
-                                pos + _dims * natus::math::vec2f_t( +1.0f, -0.0f ),
-                                colors[_level.layout[i]], borders[_level.layout[i]]
-                            ) ;
-                            pos += natus::math::vec2f_t( _dims.x(), 0.0f ) ;
+                            size_t const c = cy * chunks_x + cx ;
+                            auto & cache = _chunk_cache[ c ] ;
+                            if( cache.rev == v.revs[c] ) continue ;
+
+                            cache.rev = v.revs[c] ;
+                            cache.dirty = true ;
+                            std::copy( v.bits.begin() + c * cs, v.bits.begin() + (c + 1) * cs, cache.bits.begin() ) ;
+                        }
+                    }
+
+                    lk.unlock() ;
+
+                    for( size_t cy=cy0; cy<cy1; ++cy )
+                    {
+                        for( size_t cx=cx0; cx<cx1; ++cx )
+                        {
+                            auto & cache = _chunk_cache[ cy * chunks_x + cx ] ;
+
+                            size_t const x0 = cx * cs ;
+                            size_t const y0 = cy * cs ;
+                            size_t const x1 = std::min( x0 + cs, w ) ;
+                            size_t const y1 = std::min( y0 + cs, h ) ;
+
+                            if( cache.dirty )
+                            {
+                                cache.dirty = false ;
+                                cache.set.clear() ;
+                                cache.empty.clear() ;
+
+                                for( size_t y=y0; y<y1; ++y )
+                                {
+                                    uint32_t const bits = cache.bits[ y - y0 ] ;
+                                    for( size_t x=x0; x<x1; ++x )
+                                    {
+                                        natus::math::vec2f_t const pos = _dims * natus::math::vec2f_t( float_t( x ), float_t( y ) ) ;
+                                        if( (bits >> (x - x0)) & 1 ) cache.set.emplace_back( pos ) ;
+                                        else if( grid ) cache.empty.emplace_back( pos ) ;
+                                    }
+                                }
+                            }
+
+                            // one rect for all empty cells
+                            if( !grid )
+                            {
+                                draw_cell( 4, origin + _dims * natus::math::vec2f_t( float_t( x0 ), float_t( y0 ) ), 
+                                    _dims * natus::math::vec2f_t( float_t( x1 - x0 ), float_t( y1 - y0 ) ), 0 ) ;
+                            }
+
+                            for( auto const & p : cache.empty ) draw_cell( 5, origin + p, _dims, 0 ) ;
+                            for( auto const & p : cache.set ) draw_cell( 5, origin + p, _dims, 1 ) ;
                         }
-                        pos = natus::math::vec2f_t( -800.0f * 0.5f, pos.y() ) ;
-                        pos += natus::math::vec2f_t( 0.0f, _dims.y() ) ;
                     }
                 }
 
                 // draw player
                 {
-                    #if 0
-                    natus::math::vec2f_t const cell = (_player.pos / _dims).floored() ;
-                    natus::math::vec2f_t pos = natus::math::vec2f_t( 800.0f, 600.0f ) * natus::math::vec2f_t( -0.5f ) + cell * _dims ;
-                    _player.comp.set_shape( _player.comp.cur_shape, pos, _dims ) ;
-                    #endif
-
                     #if 1
-                    for( size_t i=0; i<_player.comp.shape_elems; ++i )
+                    for( size_t i=0; i<shape_elems; ++i )
                     {
-                        natus::math::vec2f_t const pcell = (_player.comp.shape[i] / _dims).floored() ;
-                        natus::math::vec2f_t pos = natus::math::vec2f_t( 800.0f, 600.0f ) * natus::math::vec2f_t( -0.5f ) + pcell * _dims ;
+                        auto const c = shape[i] ;
+                        natus::math::vec2f_t const pcell( float_t( c.x ), float_t( c.y ) ) ;
+                        natus::math::vec2f_t pos = origin + pcell * _dims ;
 
                         pr->draw_rect( 6, 
                         pos + _dims * natus::math::vec2f_t( -0.0f, -0.0f ),
@@ -671,7 +1500,7 @@ namespace paddle_n_ball
             //********************************************************************************
             void_t on_debug_graphics( natus::gfx::primitive_render_2d_res_t pr, size_t const milli_dt ) noexcept
             {
-                if( !_is_init ) return ;
+                if( _level->load() == nullptr ) return ;
             }
     };
 
@@ -684,6 +1513,17 @@ namespace paddle_n_ball
     {
         natus_this_typedefs( game_app ) ;
 
+    private: // startup
+
+        startup_trace_ptr_t _trace ;
+
+    private: // timing
+
+        // physics runs in fixed steps, logic gets whole milliseconds and
+        // carries the rest to the next call
+        fixed_step_t _physics_step { 60 } ;
+        size_t _logic_us = 0 ;
+
     private: // device
 
         natus::device::three_device_res_t _dev_mouse ;
@@ -725,6 +1565,10 @@ namespace paddle_n_ball
 
         the_game _game ;
 
+        // in cells. see --board
+        size_t _board_w = 40 ;
+        size_t _board_h = 60 ;
+
     private: // audio
 
         natus::audio::async_access_t _audio ;
@@ -761,6 +1605,12 @@ namespace paddle_n_ball
             _db = natus::io::database_t( natus::io::path_t( DATAPATH ), "./working", "data" ) ;
             _audio = this_t::create_audio_engine() ;
         }
+        game_app( bool_t const bot, size_t const board_w, size_t const board_h ) : this_t()
+        {
+            _game.set_bot( bot ) ;
+            _board_w = board_w ;
+            _board_h = board_h ;
+        }
         game_app( this_cref_t ) = delete ;
         game_app( this_rref_t rhv ) noexcept : app( ::std::move( rhv ) ) 
         {
@@ -776,6 +1626,8 @@ namespace paddle_n_ball
             _fb = std::move( rhv._fb ) ;
 
             _game = std::move( rhv._game ) ;
+            _board_w = rhv._board_w ;
+            _board_h = rhv._board_h ;
 
             _audio = std::move( rhv._audio ) ;
         }
@@ -823,6 +1675,8 @@ namespace paddle_n_ball
 
         virtual natus::application::result on_init( void_t ) noexcept
         { 
+            _trace = std::make_shared< startup_trace_t >( "tetrix", DATAPATH "/startup_report.json" ) ;
+
             natus::device::global_t::system()->search( [&] ( natus::device::idevice_res_t dev_in )
             {
                 if( natus::device::three_device_res_t::castable( dev_in ) )
@@ -852,6 +1706,8 @@ namespace paddle_n_ball
 
             // root render states
             {
+                auto const ph = _trace->begin( "root render states" ) ;
+
                 natus::graphics::state_object_t so = natus::graphics::state_object_t(
                     "root_render_states" ) ;
 
@@ -881,10 +1737,14 @@ namespace paddle_n_ball
                 {
                     a.configure( _root_render_states ) ;
                 } ) ;
+
+                _trace->end( ph ) ;
             }
 
             // root render states
             {
+                auto const ph = _trace->begin( "framebuffer render states" ) ;
+
                 natus::graphics::state_object_t so = natus::graphics::state_object_t(
                     "fb_render_states" ) ;
 
@@ -918,29 +1778,39 @@ namespace paddle_n_ball
                 {
                     a.configure( _fb_render_states ) ;
                 } ) ;
+
+                _trace->end( ph ) ;
             }
 
             // prepare sprite render
             {
+                auto const ph = _trace->begin( "prepare sprite render" ) ;
+
                 _sr = natus::gfx::sprite_render_2d_res_t( natus::gfx::sprite_render_2d_t() ) ;
                 _sr->init( "sprite_render", "image_array", _graphics ) ;
+
+                _trace->end( ph ) ;
             }
             
             // prepare primitive
             {
+                auto const ph = _trace->begin( "prepare primitive" ) ;
+
                 _pr = natus::gfx::primitive_render_2d_res_t( natus::gfx::primitive_render_2d_t() ) ;
                 _pr->init( "prim_render", _graphics ) ;
+
+                _trace->end( ph ) ;
             }
 
             // import fonts and create text render
             {
+                auto const ph = _trace->begin( "font raster" ) ;
+
                 natus::property::property_sheet_res_t ps = natus::property::property_sheet_t() ;
 
                 {
-                    natus::font::code_points_t pts ;
-                    for( uint32_t i = 33; i <= 126; ++i ) pts.emplace_back( i ) ;
-                    for( uint32_t i : {uint32_t( 0x00003041 )} ) pts.emplace_back( i ) ;
-                    ps->set_value< natus::font::code_points_t >( "code_points", pts ) ;
+                    ps->set_value< natus::font::code_points_t >( "code_points", 
+                        make_code_points( { TITLE, "0123456789" } ) ) ;
                 }
 
                 #if 0
@@ -968,10 +1838,14 @@ namespace paddle_n_ball
                     _tr = natus::gfx::text_render_2d_res_t( natus::gfx::text_render_2d_t( "text_render", _graphics ) ) ;
                     _tr->init( std::move( *ii->obj ), NUM_LAYERS ) ;
                 }
+
+                _trace->end( ph, startup_trace_t::file_size( "fonts/LCD_Solid.ttf" ) ) ;
             }
 
             // framebuffer
             {
+                auto const ph = _trace->begin( "framebuffer" ) ;
+
                 _fb = natus::graphics::framebuffer_object_t( "the_scene" ) ;
                 _fb->set_target( natus::graphics::color_target_type::rgba_uint_8, 1 )
                     .resize( size_t(_screen_target.x()), size_t(_screen_target.y()) ) ;
@@ -980,19 +1854,28 @@ namespace paddle_n_ball
                 {
                     a.configure( _fb ) ;
                 } ) ;
+
+                _trace->end( ph, size_t(_screen_target.x()) * size_t(_screen_target.y()) * 4 ) ;
             }
 
             // prepare quad
             {
+                auto const ph = _trace->begin( "prepare quad" ) ;
+
                 _quad = natus::gfx::quad_res_t( natus::gfx::quad_t("post_map") ) ;
                 _quad->init( _graphics ) ;
                 _quad->set_texture("the_scene.0") ;
+
+                _trace->end( ph ) ;
             }
 
             {
                 the_game::init_data id ;
                 id.db = _db ;
                 id.audio = _audio ;
+                id.trace = _trace ;
+                id.board_w = _board_w ;
+                id.board_h = _board_h ;
 
                 natus::concurrent::global_t::schedule( _game.on_init( std::move( id ) ), 
                     natus::concurrent::schedule_type::loose ) ;
@@ -1142,6 +2025,9 @@ namespace paddle_n_ball
                 }
             }
 
+            // app phases are done. game phases may still run in the background.
+            _trace->seal() ;
+
             return natus::application::result::ok ; 
         }
 
@@ -1178,7 +2064,11 @@ namespace paddle_n_ball
 
         virtual natus::application::result on_logic( logic_data_in_t d ) noexcept 
         { 
-            _game.on_logic( d.micro_dt / 1000 ) ;
+            _logic_us += d.micro_dt ;
+            size_t const milli_dt = _logic_us / 1000 ;
+            _logic_us -= milli_dt * 1000 ;
+
+            _game.on_logic( milli_dt ) ;
 
             //NATUS_PROFILING_COUNTER_HERE( "Logic Clock" ) ;
             return natus::application::result::ok ; 
@@ -1192,14 +2082,16 @@ namespace paddle_n_ball
 
         virtual natus::application::result on_audio( natus::application::app_t::audio_data_in_t ) noexcept 
         { 
-            _game.on_audio( _audio ) ;
             return natus::application::result::ok ; 
         }
 
         virtual natus::application::result on_physics( natus::application::app_t::physics_data_in_t pd ) noexcept
         { 
             //natus::log::global_t::status( "physics: " + std::to_string( pd.micro_dt ) ) ;
-            _game.on_physics( pd.micro_dt / 1000 ) ;
+            _physics_step.advance( pd.micro_dt, [&]( size_t const step_us )
+            {
+                _game.on_physics( step_us ) ;
+            } ) ;
             //NATUS_PROFILING_COUNTER_HERE( "Physics Clock" ) ;
             return natus::application::result::ok ; 
         }
@@ -1238,7 +2130,7 @@ namespace paddle_n_ball
 
             {
                 _tr->draw_text( 0, 0, 10, natus::math::vec2f_t(-0.1f, 0.7f), 
-                    natus::math::vec4f_t(1.0f), "Tetrix" ) ;
+                    natus::math::vec4f_t(1.0f), TITLE ) ;
             }
 
             {
@@ -1327,7 +2219,42 @@ namespace paddle_n_ball
 
 int main( int argc, char ** argv )
 {
+    // --bot : the placement bot plays
+    // --board <w>x<h> : the board size in cells, up to 8192 each
+    // --soak <games> : plays games headless with the bot on the board, logs the 
+    //                  throughput and exits
+    // --pieces <n> : a soak game ends after n pieces at most, 500 by default
+    bool bot = false ;
+    size_t board_w = 40 ;
+    size_t board_h = 60 ;
+    size_t soak_games = 0 ;
+    size_t soak_pieces = 500 ;
+    for( int i=1; i<argc; ++i ) 
+    {
+        if( std::strcmp( argv[i], "--bot" ) == 0 ) bot = true ;
+        else if( std::strcmp( argv[i], "--board" ) == 0 && i + 1 < argc )
+        {
+            char * end = nullptr ;
+            board_w = std::min( std::max( size_t( std::strtoul( argv[++i], &end, 10 ) ), size_t( 4 ) ), size_t( 8192 ) ) ;
+            board_h = *end == 'x' ? std::min( std::max( size_t( std::strtoul( end + 1, nullptr, 10 ) ), size_t( 4 ) ), size_t( 8192 ) ) : board_w ;
+        }
+        else if( std::strcmp( argv[i], "--soak" ) == 0 && i + 1 < argc )
+        {
+            soak_games = size_t( std::strtoul( argv[++i], nullptr, 10 ) ) ;
+        }
+        else if( std::strcmp( argv[i], "--pieces" ) == 0 && i + 1 < argc )
+        {
+            soak_pieces = std::max( size_t( std::strtoul( argv[++i], nullptr, 10 ) ), size_t( 1 ) ) ;
+        }
+    }
+
+    if( soak_games != 0 )
+    {
+        paddle_n_ball::the_game::soak( soak_games, board_w, board_h, soak_pieces ) ;
+        return 0 ;
+    }
+
     return natus::application::global_t::create_application( 
-        paddle_n_ball::game_app_res_t( paddle_n_ball::game_app_t() ) )->exec() ;
+        paddle_n_ball::game_app_res_t( paddle_n_ball::game_app_t( bot, board_w, board_h ) ) )->exec() ;
 }
  
\ No newline at end of file
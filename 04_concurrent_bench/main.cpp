@@ -0,0 +1,224 @@
+
+#include <natus/concurrent/global.h>
+#include <natus/log/global.h>
+
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+
+namespace concurrent_bench
+{
+    using namespace natus::core::types ;
+
+    typedef std::chrono::high_resolution_clock clock_t ;
+
+    // blocks until signal() was called
+    class wait_flag
+    {
+        natus_this_typedefs( wait_flag ) ;
+
+    private:
+
+        std::mutex _mtx ;
+        std::condition_variable _cv ;
+        bool_t _set = false ;
+
+    public:
+
+        void_t signal( void_t ) noexcept
+        {
+            std::lock_guard< std::mutex > lk( _mtx ) ;
+            _set = true ;
+            _cv.notify_all() ;
+        }
+
+        void_t wait( void_t ) noexcept
+        {
+            std::unique_lock< std::mutex > lk( _mtx ) ;
+            _cv.wait( lk, [&]( void_t ){ return _set ; } ) ;
+        }
+    };
+    natus_typedef( wait_flag ) ;
+
+    static size_t micro_since( clock_t::time_point const tp ) noexcept
+    {
+        return size_t( std::chrono::duration_cast< std::chrono::microseconds >( clock_t::now() - tp ).count() ) ;
+    }
+
+    static size_t nano_since( clock_t::time_point const tp ) noexcept
+    {
+        return size_t( std::chrono::duration_cast< std::chrono::nanoseconds >( clock_t::now() - tp ).count() ) ;
+    }
+
+    static void_t report( natus::ntd::string_t const & name, natus::ntd::string_t const & what ) noexcept
+    {
+        natus::log::global_t::status( "[" + name + "] : " + what ) ;
+    }
+
+    // some work per task so fan-out tasks do not finish before the next starts
+    static size_t spin( size_t const iterations ) noexcept
+    {
+        size_t volatile x = 0 ;
+        for( size_t i=0; i<iterations; ++i ) x = x + i ;
+        return x ;
+    }
+
+    // the cost of creating a task object
+    static void_t bench_create( size_t const n ) noexcept
+    {
+        natus::ntd::vector< natus::concurrent::task_res_t > tasks ;
+        tasks.reserve( n ) ;
+
+        auto const tp = clock_t::now() ;
+        for( size_t i=0; i<n; ++i )
+        {
+            tasks.emplace_back( natus::concurrent::task_t( [=]( natus::concurrent::task_res_t ){} ) ) ;
+        }
+        size_t const ns = nano_since( tp ) ;
+
+        report( "create", std::to_string( n ) + " tasks : " + std::to_string( ns / n ) + " ns per task" ) ;
+    }
+
+    // the cost of then() without the task creation and the cost of 
+    // running the whole chain
+    static void_t bench_then( size_t const n ) noexcept
+    {
+        natus::ntd::vector< natus::concurrent::task_res_t > tasks ;
+        tasks.reserve( n ) ;
+
+        for( size_t i=0; i<n; ++i )
+        {
+            tasks.emplace_back( natus::concurrent::task_t( [=]( natus::concurrent::task_res_t ){} ) ) ;
+        }
+
+        wait_flag_t done ;
+        natus::concurrent::task_res_t last = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
+        {
+            done.signal() ;
+        } ) ;
+
+        auto const tp = clock_t::now() ;
+        for( size_t i=1; i<n; ++i ) tasks[i-1]->then( tasks[i] ) ;
+        size_t const ns = nano_since( tp ) ;
+
+        tasks[n-1]->then( last ) ;
+
+        auto const tp2 = clock_t::now() ;
+        natus::concurrent::global_t::schedule( tasks[0], natus::concurrent::schedule_type::loose ) ;
+        done.wait() ;
+        size_t const us = micro_since( tp2 ) ;
+
+        report( "then", std::to_string( n ) + " links : " + std::to_string( ns / n ) + " ns per then, chain ran in " + 
+            std::to_string( us ) + " us (" + std::to_string( (us * 1000) / n ) + " ns per task)" ) ;
+    }
+
+    // the time from schedule() until the task body runs
+    static void_t bench_latency( size_t const n ) noexcept
+    {
+        natus::ntd::vector< size_t > samples ;
+        samples.reserve( n ) ;
+
+        for( size_t i=0; i<n; ++i )
+        {
+            wait_flag_t done ;
+            size_t ns = 0 ;
+            clock_t::time_point tp ;
+
+            natus::concurrent::task_res_t t = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
+            {
+                ns = nano_since( tp ) ;
+                done.signal() ;
+            } ) ;
+
+            tp = clock_t::now() ;
+            natus::concurrent::global_t::schedule( t, natus::concurrent::schedule_type::loose ) ;
+            done.wait() ;
+
+            samples.emplace_back( ns ) ;
+        }
+
+        std::sort( samples.begin(), samples.end() ) ;
+
+        size_t sum = 0 ;
+        for( auto const s : samples ) sum += s ;
+
+        report( "latency", std::to_string( n ) + " schedules : mean " + std::to_string( sum / n ) + 
+            " ns, median " + std::to_string( samples[ n / 2 ] ) + 
+            " ns, p99 " + std::to_string( samples[ (n * 99) / 100 ] ) + 
+            " ns, max " + std::to_string( samples.back() ) + " ns" ) ;
+    }
+
+    // root -> width tasks -> finish, like the init graphs of the games. 
+    // Reports the time per graph and the task throughput.
+    static void_t bench_fan( size_t const width, size_t const reps, size_t const work ) noexcept
+    {
+        size_t total_us = 0 ;
+
+        for( size_t r=0; r<reps; ++r )
+        {
+            wait_flag_t done ;
+
+            natus::concurrent::task_res_t root = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t ){} ) ;
+            natus::concurrent::task_res_t finish = natus::concurrent::task_t( [&]( natus::concurrent::task_res_t )
+            {
+                done.signal() ;
+            } ) ;
+
+            for( size_t i=0; i<width; ++i )
+            {
+                natus::concurrent::task_res_t t = natus::concurrent::task_t( [=]( natus::concurrent::task_res_t )
+                {
+                    spin( work ) ;
+                } ) ;
+                root->then( t )->then( finish ) ;
+            }
+
+            auto const tp = clock_t::now() ;
+            natus::concurrent::global_t::schedule( root, natus::concurrent::schedule_type::loose ) ;
+            done.wait() ;
+            total_us += micro_since( tp ) ;
+        }
+
+        size_t const us = total_us / reps ;
+        size_t const per_sec = us == 0 ? 0 : (width * 1000000) / us ;
+
+        report( "fan", "width " + std::to_string( width ) + ", work " + std::to_string( work ) + " : " + 
+            std::to_string( us ) + " us per graph, " + std::to_string( per_sec ) + " tasks/s" ) ;
+    }
+}
+
+// --quick : fewer repetitions
+int main( int argc, char ** argv )
+{
+    using namespace concurrent_bench ;
+
+    bool quick = false ;
+    for( int i=1; i<argc; ++i ) 
+        quick = quick || std::strcmp( argv[i], "--quick" ) == 0 ;
+
+    size_t const n = quick ? 10000 : 100000 ;
+    size_t const reps = quick ? 10 : 100 ;
+
+    report( "bench", "hardware threads : " + std::to_string( std::thread::hardware_concurrency() ) ) ;
+
+    // warm up the scheduler
+    bench_fan( 8, 10, 0 ) ;
+
+    bench_create( n ) ;
+    bench_then( n ) ;
+    bench_latency( quick ? 1000 : 10000 ) ;
+
+    for( size_t const work : { size_t( 0 ), size_t( 100000 ) } )
+    {
+        for( size_t w=1; w<=64; w*=2 )
+        {
+            bench_fan( w, reps, work ) ;
+        }
+    }
+
+    return 0 ;
+}
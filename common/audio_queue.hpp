@@ -0,0 +1,271 @@
+#pragma once
+
+#include "spsc_ring.hpp"
+
+#include <natus/application/app.h>
+#include <natus/log/global.h>
+
+#include <chrono>
+#include <algorithm>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // audio commands go from the game callbacks to the audio callback without 
+    // locks. Every producing callback owns a ring so each ring has exactly one
+    // producer. Buffers are registered once and commands refer to them by id
+    // so a command is a few bytes and trivially copyable.
+    //
+    // The audio callback coalesces equal commands of one frame and keeps a 
+    // bounded set of voices. Each buffer has a voice cap, a priority and the
+    // time a voice is assumed to sound. If a cap is hit, the oldest voice of
+    // the lowest priority is stolen or the command is dropped.
+    class audio_queue
+    {
+        natus_this_typedefs( audio_queue ) ;
+
+        typedef std::chrono::high_resolution_clock clock_t ;
+
+    public:
+
+        enum class producer
+        {
+            device,
+            logic,
+            physics,
+            num_producers
+        };
+
+        struct command
+        {
+            uint16_t buffer = 0 ;
+            natus::audio::execution_options eo = natus::audio::execution_options::play ;
+            bool_t loop = false ;
+        };
+        natus_typedef( command ) ;
+
+        struct voice_params
+        {
+            size_t max_voices = 2 ;
+            size_t priority = 0 ;
+            std::chrono::milliseconds dur = std::chrono::milliseconds( 250 ) ;
+        };
+        natus_typedef( voice_params ) ;
+
+    private:
+
+        static size_t const max_buffers = 32 ;
+        static size_t const ring_size = 64 ;
+        static size_t const max_voices = 16 ;
+
+        // never reallocated so registering does not race with draining
+        natus::audio::buffer_object_res_t _buffers[ max_buffers ] ;
+        voice_params_t _params[ max_buffers ] ;
+        size_t _num_buffers = 0 ;
+
+        spsc_ring< command_t, ring_size > _rings[ size_t( producer::num_producers ) ] ;
+
+    private: // only touched by the audio callback
+
+        struct voice
+        {
+            bool_t used = false ;
+            bool_t loop = false ;
+            uint16_t buffer = 0 ;
+            clock_t::time_point tp ;
+        };
+        voice _voices[ max_voices ] ;
+
+    public:
+
+        audio_queue( void_t ) noexcept {}
+        audio_queue( this_cref_t ) = delete ;
+        audio_queue( this_rref_t ) = delete ;
+
+    public:
+
+        uint16_t add_buffer( natus::audio::buffer_object_res_t b ) noexcept
+        {
+            return this_t::add_buffer( b, voice_params_t() ) ;
+        }
+
+        // must be called before the first command for that buffer is pushed
+        uint16_t add_buffer( natus::audio::buffer_object_res_t b, voice_params_cref_t vp ) noexcept
+        {
+            if( _num_buffers == max_buffers )
+            {
+                natus::log::global_t::error( "[audio_queue] : too many buffers" ) ;
+                return 0 ;
+            }
+            _buffers[ _num_buffers ] = b ;
+            _params[ _num_buffers ] = vp ;
+            return uint16_t( _num_buffers++ ) ;
+        }
+
+        // drops the command if the ring of that producer is full
+        bool_t push( producer const p, uint16_t const buffer, 
+            natus::audio::execution_options const eo, bool_t const loop = false ) noexcept
+        {
+            command_t c ;
+            c.buffer = buffer ;
+            c.eo = eo ;
+            c.loop = loop ;
+            return _rings[ size_t( p ) ].push( c ) ;
+        }
+
+        // collects the commands of all producers into one batch and submits 
+        // the batch in one pass. Only called from the audio callback.
+        //
+        // Commands are processed in push order per producer. Stops are sent
+        // right away and cancel the plays of their buffer pushed before them
+        // in the same frame. The plays left are sent last, so stops free the
+        // voices first.
+        void_t drain( natus::audio::async_access_t audio ) noexcept
+        {
+            command_t batch[ size_t( producer::num_producers ) * ring_size ] ;
+            size_t num = 0 ;
+
+            for( auto & r : _rings )
+            {
+                r.drain( [&]( command_cref_t c ) { batch[ num++ ] = c ; } ) ;
+            }
+
+            if( num == 0 ) return ;
+
+            auto const now = clock_t::now() ;
+
+            // free voices that are done
+            for( auto & v : _voices )
+            {
+                if( v.used && !v.loop && (now - v.tp) > _params[v.buffer].dur ) v.used = false ;
+            }
+
+            auto const execute = [&]( uint16_t const buffer, natus::audio::execution_options const eo, bool_t const loop )
+            {
+                natus::audio::backend::execute_detail ed ;
+                ed.to = eo ;
+                ed.loop = loop ;
+                audio.execute( _buffers[ buffer ], ed ) ;
+            } ;
+
+            // the pending plays are compacted to the front of the batch
+            size_t num_plays = 0 ;
+            bool_t stopped[ max_buffers ] = {} ;
+
+            for( size_t i=0; i<num; ++i )
+            {
+                command_t const c = batch[i] ;
+
+                if( c.eo == natus::audio::execution_options::play )
+                {
+                    // equal plays of the same frame are submitted once
+                    bool_t const dup = std::any_of( batch, batch + num_plays, [&]( command_cref_t p )
+                    {
+                        return p.buffer == c.buffer && p.loop == c.loop ;
+                    } ) ;
+                    if( !dup ) batch[ num_plays++ ] = c ;
+                    continue ;
+                }
+
+                num_plays = size_t( std::remove_if( batch, batch + num_plays, [&]( command_cref_t p )
+                {
+                    return p.buffer == c.buffer ;
+                } ) - batch ) ;
+
+                // the plays before it are cancelled, so a second stop has 
+                // nothing left to stop
+                if( stopped[ c.buffer ] ) continue ;
+                stopped[ c.buffer ] = true ;
+
+                for( auto & v : _voices ) if( v.buffer == c.buffer ) v.used = false ;
+                execute( c.buffer, c.eo, c.loop ) ;
+            }
+            num = num_plays ;
+
+            // plays with higher priority get the voices first
+            std::stable_sort( batch, batch + num, [&]( command_cref_t a, command_cref_t b )
+            {
+                return _params[a.buffer].priority > _params[b.buffer].priority ;
+            } ) ;
+
+            for( size_t i=0; i<num; ++i )
+            {
+                auto const & c = batch[i] ;
+
+                size_t const v = this_t::find_voice( c.buffer, now ) ;
+                if( v == size_t( -1 ) ) continue ;
+
+                // a stolen voice of another buffer is stopped if it was its last
+                uint16_t const stolen = _voices[v].buffer ;
+                bool_t const steal = _voices[v].used && stolen != c.buffer ;
+
+                _voices[v].used = true ;
+                _voices[v].loop = c.loop ;
+                _voices[v].buffer = c.buffer ;
+                _voices[v].tp = now ;
+
+                if( steal && !this_t::is_sounding( stolen ) ) 
+                {
+                    execute( stolen, natus::audio::execution_options::stop, false ) ;
+                }
+                execute( c.buffer, c.eo, c.loop ) ;
+            }
+        }
+
+    private:
+
+        // returns the voice to use for the buffer or size_t(-1) if the 
+        // command needs to be dropped.
+        size_t find_voice( uint16_t const buffer, clock_t::time_point const now ) const noexcept
+        {
+            auto const & vp = _params[ buffer ] ;
+
+            // per buffer cap : restart the oldest voice of that buffer
+            {
+                size_t num = 0 ;
+                size_t oldest = size_t( -1 ) ;
+                for( size_t i=0; i<max_voices; ++i )
+                {
+                    auto const & v = _voices[i] ;
+                    if( !v.used || v.buffer != buffer ) continue ;
+                    ++num ;
+                    if( oldest == size_t( -1 ) || v.tp < _voices[oldest].tp ) oldest = i ;
+                }
+                if( num >= vp.max_voices ) 
+                {
+                    // already restarted this frame
+                    return _voices[oldest].tp == now ? size_t( -1 ) : oldest ;
+                }
+            }
+
+            // a free voice
+            for( size_t i=0; i<max_voices; ++i )
+            {
+                if( !_voices[i].used ) return i ;
+            }
+
+            // steal the oldest voice of the lowest priority that is not higher
+            size_t steal = size_t( -1 ) ;
+            for( size_t i=0; i<max_voices; ++i )
+            {
+                auto const & v = _voices[i] ;
+                size_t const prio = _params[ v.buffer ].priority ;
+                if( prio > vp.priority ) continue ;
+
+                if( steal == size_t( -1 ) ) { steal = i ; continue ; }
+
+                size_t const sprio = _params[ _voices[steal].buffer ].priority ;
+                if( prio < sprio || (prio == sprio && v.tp < _voices[steal].tp) ) steal = i ;
+            }
+            return steal ;
+        }
+
+        bool_t is_sounding( uint16_t const buffer ) const noexcept
+        {
+            for( auto const & v : _voices ) if( v.used && v.buffer == buffer ) return true ;
+            return false ;
+        }
+    };
+    natus_typedef( audio_queue ) ;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <natus/gfx/font/text_render_2d.h>
+
+#include <algorithm>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // only the glyphs of the given texts are rasterized so the atlas 
+    // and the startup cost scale with what is actually drawn.
+    inline natus::font::code_points_t make_code_points( natus::ntd::vector< natus::ntd::string_t > const & texts ) noexcept
+    {
+        natus::font::code_points_t pts ;
+        for( auto const & t : texts )
+        {
+            for( char const c : t ) 
+            {
+                uint32_t const cp = uint32_t( uint8_t( c ) ) ;
+                if( cp > 32 ) pts.emplace_back( cp ) ;
+            }
+        }
+        std::sort( pts.begin(), pts.end() ) ;
+        pts.erase( std::unique( pts.begin(), pts.end() ), pts.end() ) ;
+        return pts ;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <natus/log/global.h>
+
+#include <atomic>
+#include <algorithm>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // hands out fixed physics steps from the variable physics delta. The delta
+    // is accumulated in microseconds so no time is lost between the calls.
+    class fixed_step
+    {
+        natus_this_typedefs( fixed_step ) ;
+
+    private:
+
+        size_t _step_us ;
+        size_t _acc_us = 0 ;
+
+        // the accumulator left after the last advance. written by physics, 
+        // read by graphics.
+        std::atomic< size_t > _rest_us { 0 } ;
+
+    public:
+
+        fixed_step( size_t const hz ) noexcept : _step_us( 1000000 / hz ) {}
+        fixed_step( this_cref_t ) = delete ;
+        fixed_step( this_rref_t ) = delete ;
+
+    public:
+
+        size_t get_step_us( void_t ) const noexcept { return _step_us ; }
+
+        // calls funk( step_us ) for every full step. After a stall at most 
+        // max_steps are taken and the rest is dropped so physics catches up.
+        template< typename funk_t >
+        size_t advance( size_t const micro_dt, funk_t funk ) noexcept
+        {
+            size_t const max_steps = 5 ;
+
+            _acc_us += micro_dt ;
+
+            size_t n = 0 ;
+            for( ; _acc_us >= _step_us && n < max_steps; ++n )
+            {
+                funk( _step_us ) ;
+                _acc_us -= _step_us ;
+            }
+            _acc_us = _acc_us % _step_us ;
+
+            _rest_us.store( _acc_us, std::memory_order_release ) ;
+
+            return n ;
+        }
+
+        // the part of a step the accumulator holds. 0 right after a step and
+        // close to 1 just before the next one. Used to interpolate between the
+        // previous and the current physics positions.
+        float_t alpha( void_t ) const noexcept
+        {
+            size_t const rest = _rest_us.load( std::memory_order_acquire ) ;
+            return std::min( float_t( rest ) / float_t( _step_us ), 1.0f ) ;
+        }
+    };
+    natus_typedef( fixed_step ) ;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "spsc_ring.hpp"
+
+#include <natus/math/vector/vector2.hpp>
+#include <natus/log/global.h>
+
+#include <chrono>
+#include <algorithm>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // input events are stamped on the device callback and consumed by the 
+    // simulation at the start of its next tick. The consumer measures the 
+    // time from stamp to consumption and logs it every few seconds.
+    //
+    // There is one producer per queue. Commands from another callback go
+    // through a queue of their own.
+    template< typename what_t >
+    class input_queue
+    {
+        natus_this_typedefs( input_queue ) ;
+
+        typedef std::chrono::high_resolution_clock clock_t ;
+
+    public:
+
+        struct event
+        {
+            what_t what ;
+            natus::math::vec2f_t value ;
+            clock_t::time_point tp ;
+        };
+        natus_typedef( event ) ;
+
+    private:
+
+        spsc_ring< event_t, 64 > _ring ;
+
+        // tags the latency report
+        char const * _name ;
+
+        // written by the consumer only
+        size_t _count = 0 ;
+        size_t _sum_us = 0 ;
+        size_t _max_us = 0 ;
+        clock_t::time_point _report_tp = clock_t::now() ;
+
+    public:
+
+        input_queue( char const * name = "input" ) noexcept : _name( name ) {}
+        input_queue( this_cref_t ) = delete ;
+        input_queue( this_rref_t ) = delete ;
+
+    public:
+
+        // device side. Returns false if the queue is full.
+        bool_t push( what_t const what, natus::math::vec2f_t const & value ) noexcept
+        {
+            return _ring.push( event_t { what, value, clock_t::now() } ) ;
+        }
+
+        bool_t push( what_t const what ) noexcept
+        {
+            return this_t::push( what, natus::math::vec2f_t() ) ;
+        }
+
+        // simulation side. Calls funk( event ) in push order.
+        template< typename funk_t >
+        size_t consume( funk_t funk ) noexcept
+        {
+            auto const now = clock_t::now() ;
+
+            size_t const n = _ring.drain( [&]( event_cref_t e )
+            {
+                // an event may be pushed after now was taken
+                size_t const us = e.tp < now ? size_t( std::chrono::duration_cast< std::chrono::microseconds >( 
+                    now - e.tp ).count() ) : 0 ;
+                ++_count ;
+                _sum_us += us ;
+                _max_us = std::max( _max_us, us ) ;
+
+                funk( e ) ;
+            } ) ;
+
+            if( now - _report_tp > std::chrono::seconds( 5 ) )
+            {
+                if( _count != 0 )
+                {
+                    natus::log::global_t::status( "[" + natus::ntd::string_t( _name ) + "] : " + std::to_string( _count ) + " events, latency mean " + 
+                        std::to_string( _sum_us / _count ) + " us, max " + std::to_string( _max_us ) + " us" ) ;
+                }
+
+                _count = 0 ;
+                _sum_us = 0 ;
+                _max_us = 0 ;
+                _report_tp = now ;
+            }
+
+            return n ;
+        }
+    };
+}
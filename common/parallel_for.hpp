@@ -0,0 +1,88 @@
+#pragma once
+
+#include <natus/concurrent/global.h>
+#include <natus/log/global.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // runs funk( begin, end ) over chunks of [0,n) and returns when all 
+    // chunks are done. Ranges smaller than two grains run on the caller. 
+    // max_tasks caps the chunks, 0 means one chunk per hardware thread.
+    //
+    // The caller and the helper tasks claim chunks from the same counter, so
+    // the caller only ever waits for chunks that already run on another 
+    // thread. It is safe to call from a task of the pool and to nest. A 
+    // helper that starts after all chunks are claimed exits without touching
+    // funk.
+    template< typename range_funk_t >
+    void_t parallel_for( size_t const n, size_t const grain, range_funk_t funk, size_t const max_tasks = 0 ) noexcept
+    {
+        size_t const hw = std::max( size_t( std::thread::hardware_concurrency() ), size_t( 1 ) ) ;
+        size_t const tasks = std::max( std::min( max_tasks == 0 ? hw : max_tasks, n / std::max( grain, size_t( 1 ) ) ), size_t( 1 ) ) ;
+
+        if( tasks == 1 ) 
+        {
+            funk( size_t( 0 ), n ) ;
+            return ;
+        }
+
+        struct state
+        {
+            size_t n ;
+            size_t chunk ;
+            size_t num_chunks ;
+
+            std::atomic< size_t > next { 0 } ;
+
+            std::mutex mtx ;
+            std::condition_variable cv ;
+            size_t done = 0 ;
+        };
+
+        auto st = std::make_shared< state >() ;
+        st->n = n ;
+        st->chunk = (n + tasks - 1) / tasks ;
+        st->num_chunks = (n + st->chunk - 1) / st->chunk ;
+
+        range_funk_t * const fp = &funk ;
+        auto const work = [fp]( state & s )
+        {
+            while( true )
+            {
+                size_t const i = s.next.fetch_add( 1 ) ;
+                if( i >= s.num_chunks ) return ;
+
+                size_t const b = i * s.chunk ;
+                (*fp)( b, std::min( b + s.chunk, s.n ) ) ;
+
+                std::lock_guard< std::mutex > lk( s.mtx ) ;
+                if( ++s.done == s.num_chunks ) s.cv.notify_all() ;
+            }
+        } ;
+
+        natus::concurrent::task_res_t root = natus::concurrent::task_t( []( natus::concurrent::task_res_t ){} ) ;
+        for( size_t i=1; i<st->num_chunks; ++i )
+        {
+            natus::concurrent::task_res_t t = natus::concurrent::task_t( [st, work]( natus::concurrent::task_res_t )
+            {
+                work( *st ) ;
+            } ) ;
+            root->then( t ) ;
+        }
+        natus::concurrent::global_t::schedule( root, natus::concurrent::schedule_type::loose ) ;
+
+        work( *st ) ;
+
+        std::unique_lock< std::mutex > lk( st->mtx ) ;
+        st->cv.wait( lk, [&]( void_t ){ return st->done == st->num_chunks ; } ) ;
+    }
+}
@@ -0,0 +1,535 @@
+#pragma once
+
+#include "versioned_ptr.hpp"
+#include "startup_trace.hpp"
+
+#include <natus/format/global.h>
+#include <natus/format/future_items.hpp>
+#include <natus/format/natus/natus_module.h>
+#include <natus/io/database.h>
+#include <natus/gfx/sprite/sprite_render_2d.h>
+#include <natus/concurrent/global.h>
+#include <natus/log/global.h>
+
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <filesystem>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // the sprite sheets baked from sprite_sheet.natus and their hot reload.
+    // The sheets are published as a whole so a reader loads them once per
+    // call and never sees a reload half done. A reload imports, decodes and
+    // bakes in a task and is taken over by a later poll. Only the changed
+    // sprites and animations are re-baked.
+    class sheet_reload
+    {
+        natus_this_typedefs( sheet_reload ) ;
+
+        typedef std::chrono::high_resolution_clock clock_t ;
+
+    public:
+
+        typedef versioned_ptr< natus::gfx::sprite_sheets_t const > current_sheets_t ;
+        typedef std::shared_ptr< current_sheets_t > current_sheets_ptr_t ;
+        typedef current_sheets_t::ptr_t sheets_ptr_t ;
+
+        // a reload taken over by poll
+        struct change
+        {
+            sheets_ptr_t from ;
+            sheets_ptr_t to ;
+
+            // the new images. Only set if an image changed.
+            bool_t images_changed = false ;
+            natus::graphics::image_t imgs ;
+        };
+        natus_typedef( change ) ;
+
+    private:
+
+        // a reload in flight. The task owns all but done until it sets done.
+        struct job
+        {
+            natus::io::database_res_t db ;
+            bool_t doc_changed = false ;
+            bool_t images_changed = false ;
+
+            // what the current sheets were baked from
+            natus::format::natus_document_t old_doc ;
+            natus::math::vec2f_t old_dims ;
+            sheets_ptr_t old_sheets ;
+
+            bool_t valid = false ;
+            natus::format::natus_document_t doc ;
+            natus::math::vec2f_t dims ;
+            natus::graphics::image_t imgs ;
+            std::shared_ptr< natus::gfx::sprite_sheets_t > sheets ;
+            size_t num = 0 ;
+
+            std::filesystem::file_time_type doc_time ;
+            natus::ntd::vector< std::filesystem::file_time_type > image_times ;
+
+            std::atomic< bool_t > done { false } ;
+        };
+        natus_typedef( job ) ;
+        std::shared_ptr< job_t > _job ;
+
+    private:
+
+        natus::io::database_res_t _db ;
+        startup_trace_ptr_t _trace ;
+
+        current_sheets_ptr_t _sheets = std::make_shared< current_sheets_t >() ;
+
+        // the document and the file times the current sheets were baked from.
+        // Only touched by the thread calling poll.
+        natus::format::natus_document_t _doc ;
+        std::filesystem::file_time_type _doc_time ;
+        natus::ntd::vector< std::filesystem::file_time_type > _image_times ;
+        clock_t::time_point _poll_tp ;
+
+        natus::math::vec2f_t _dims ;
+
+    public:
+
+        void_t init( natus::io::database_res_t db, startup_trace_ptr_t trace ) noexcept
+        {
+            _db = db ;
+            _trace = trace ;
+        }
+
+        // the published sheets. Handed to whoever reads them off the callbacks.
+        current_sheets_ptr_t current( void_t ) const noexcept { return _sheets ; }
+
+        sheets_ptr_t sheets( void_t ) const noexcept { return _sheets->load() ; }
+
+    public:
+
+        //********************************************************************************
+        // imports and bakes the sheets at startup. Returns false if the
+        // document can not be imported which leaves the sheets empty.
+        bool_t load( natus::graphics::image_t & imgs ) noexcept
+        {
+            _sheets->publish( std::make_shared< natus::gfx::sprite_sheets_t >(), _sheets->issue() ) ;
+
+            natus::format::module_registry_res_t mod_reg = natus::format::global_t::registry() ;
+            auto const ph_doc = _trace->begin( "natus doc" ) ;
+            auto item = mod_reg->import_from( natus::io::location_t( "sprite_sheet.natus" ), _db ) ;
+
+            natus::format::natus_item_res_t ni = item.get() ;
+            _trace->end( ph_doc, startup_trace_t::file_size( "sprite_sheet.natus" ) ) ;
+            if( !ni.is_valid() ) return false ;
+
+            natus::format::natus_document_t doc = std::move( ni->doc ) ;
+
+            // taking all slices
+            imgs = this_t::import_images( doc, _db, _trace ) ;
+
+            // make sprite animation infos
+            {
+                auto const ph_bake = _trace->begin( "sheet bake" ) ;
+
+                // as an image array is used, the max dims need to be
+                // used to compute the particular rect infos
+                _dims = natus::math::vec2f_t( imgs.get_dims().xy() ) ;
+
+                auto sheets = std::make_shared< natus::gfx::sprite_sheets_t >() ;
+                for( auto const & ss : doc.sprite_sheets )
+                {
+                    sheets->emplace_back( this_t::bake_sheet( ss, _dims ) ) ;
+                }
+                _sheets->publish( sheets, _sheets->issue() ) ;
+
+                _trace->end( ph_bake ) ;
+            }
+
+            _doc = std::move( doc ) ;
+            this_t::file_times( _doc, _doc_time, _image_times ) ;
+            _poll_tp = clock_t::now() ;
+
+            return true ;
+        }
+
+        //********************************************************************************
+        // polls the sprite sheet document and its images and starts a reload
+        // on change. Returns true if a finished reload was published. The
+        // caller remaps what it derived from change.from.
+        bool_t poll( change_ref_t out ) noexcept
+        {
+            if( _job != nullptr )
+            {
+                if( !_job->done ) return false ;
+
+                auto j = std::move( _job ) ;
+
+                return this_t::take_over( *j, out ) ;
+            }
+
+            if( (clock_t::now() - _poll_tp) < std::chrono::milliseconds( 500 ) ) return false ;
+            _poll_tp = clock_t::now() ;
+
+            std::filesystem::file_time_type doc_time ;
+            natus::ntd::vector< std::filesystem::file_time_type > image_times ;
+            this_t::file_times( _doc, doc_time, image_times ) ;
+
+            bool_t const doc_changed = doc_time != _doc_time ;
+            bool_t const images_changed = image_times != _image_times ;
+
+            if( !doc_changed && !images_changed ) return false ;
+
+            auto j = std::make_shared< job_t >() ;
+            j->db = _db ;
+            j->doc_changed = doc_changed ;
+            j->images_changed = images_changed ;
+            j->old_doc = _doc ;
+            j->old_dims = _dims ;
+            j->old_sheets = _sheets->load() ;
+            _job = j ;
+
+            natus::concurrent::task_res_t t = natus::concurrent::task_t( [j]( natus::concurrent::task_res_t )
+            {
+                this_t::reload( *j ) ;
+                j->done = true ;
+            } ) ;
+            natus::concurrent::global_t::schedule( t, natus::concurrent::schedule_type::loose ) ;
+
+            return false ;
+        }
+
+    private:
+
+        //********************************************************************************
+        // runs in the reload task
+        static void_t reload( job_ref_t j ) noexcept
+        {
+            natus::format::natus_document_t doc ;
+            bool_t images_changed = j.images_changed ;
+
+            if( j.doc_changed )
+            {
+                natus::format::module_registry_res_t mod_reg = natus::format::global_t::registry() ;
+                natus::format::natus_item_res_t ni = mod_reg->import_from(
+                    natus::io::location_t( "sprite_sheet.natus" ), j.db ).get() ;
+
+                if( !ni.is_valid() )
+                {
+                    // probably caught while being written. try again next poll.
+                    natus::log::global_t::warning( "[hot reload] : can not import sprite_sheet.natus" ) ;
+                    return ;
+                }
+                doc = std::move( ni->doc ) ;
+
+                // image sources may have changed too
+                images_changed = images_changed || doc.sprite_sheets.size() != j.old_doc.sprite_sheets.size() ;
+                for( size_t i=0; !images_changed && i<doc.sprite_sheets.size(); ++i )
+                {
+                    images_changed = doc.sprite_sheets[i].image.src != j.old_doc.sprite_sheets[i].image.src ;
+                }
+            }
+            else doc = j.old_doc ;
+
+            bool_t force = false ;
+            natus::math::vec2f_t dims = j.old_dims ;
+
+            if( images_changed )
+            {
+                j.imgs = this_t::import_images( doc, j.db, nullptr ) ;
+
+                auto const d = natus::math::vec2f_t( j.imgs.get_dims().xy() ) ;
+
+                // all rects are relative to the image array dims
+                force = d.x() != dims.x() || d.y() != dims.y() ;
+                dims = d ;
+            }
+
+            auto sheets = std::make_shared< natus::gfx::sprite_sheets_t >( *j.old_sheets ) ;
+
+            size_t num = 0 ;
+            sheets->resize( doc.sprite_sheets.size() ) ;
+            for( size_t i=0; i<doc.sprite_sheets.size(); ++i )
+            {
+                if( force || i >= j.old_doc.sprite_sheets.size() )
+                {
+                    (*sheets)[i] = this_t::bake_sheet( doc.sprite_sheets[i], dims ) ;
+                    num += doc.sprite_sheets[i].sprites.size() + doc.sprite_sheets[i].animations.size() ;
+                    continue ;
+                }
+                num += this_t::patch_sheet( j.old_doc.sprite_sheets[i], doc.sprite_sheets[i], dims, (*sheets)[i] ) ;
+            }
+
+            this_t::file_times( doc, j.doc_time, j.image_times ) ;
+
+            j.doc = std::move( doc ) ;
+            j.dims = dims ;
+            j.images_changed = images_changed ;
+            j.sheets = std::move( sheets ) ;
+            j.num = num ;
+            j.valid = true ;
+        }
+
+        //********************************************************************************
+        // publishes a finished reload. A failed reload keeps the old file
+        // times so the next poll tries again.
+        bool_t take_over( job_ref_t j, change_ref_t out ) noexcept
+        {
+            if( !j.valid ) return false ;
+
+            out.from = _sheets->load() ;
+            out.to = j.sheets ;
+            out.images_changed = j.images_changed ;
+            if( j.images_changed ) out.imgs = std::move( j.imgs ) ;
+
+            _sheets->publish( j.sheets, _sheets->issue() ) ;
+
+            _doc = std::move( j.doc ) ;
+            _dims = j.dims ;
+            _doc_time = j.doc_time ;
+            _image_times = std::move( j.image_times ) ;
+
+            natus::log::global_t::status( "[hot reload] : " + std::to_string( j.num ) + " sprites/animations re-baked" +
+                (j.images_changed ? ", image array re-uploaded" : "") ) ;
+
+            return true ;
+        }
+
+    public:
+
+        //********************************************************************************
+        static natus::graphics::image_object_res_t make_image_array( natus::graphics::image_t && imgs ) noexcept
+        {
+            return natus::graphics::image_object_t( "image_array", std::move( imgs ) )
+                .set_type( natus::graphics::texture_type::texture_2d_array )
+                .set_wrap( natus::graphics::texture_wrap_mode::wrap_s, natus::graphics::texture_wrap_type::repeat )
+                .set_wrap( natus::graphics::texture_wrap_mode::wrap_t, natus::graphics::texture_wrap_type::repeat )
+                .set_filter( natus::graphics::texture_filter_mode::min_filter, natus::graphics::texture_filter_type::nearest )
+                .set_filter( natus::graphics::texture_filter_mode::mag_filter, natus::graphics::texture_filter_type::nearest );
+        }
+
+    private:
+
+        //********************************************************************************
+        // decodes the images of all sheets. Only traced if trace is set.
+        static natus::graphics::image_t import_images( natus::format::natus_document_t const & doc,
+            natus::io::database_res_t db, startup_trace_ptr_t trace ) noexcept
+        {
+            natus::graphics::image_t imgs ;
+
+            natus::format::module_registry_res_t mod_reg = natus::format::global_t::registry() ;
+
+            natus::ntd::vector< natus::format::future_item_t > futures ;
+            natus::ntd::vector< size_t > phases ;
+            for( auto const & ss : doc.sprite_sheets )
+            {
+                if( trace != nullptr ) phases.emplace_back( trace->begin( "image decode " + ss.image.src ) ) ;
+
+                auto const l = natus::io::location_t::from_path( natus::io::path_t(ss.image.src) ) ;
+                futures.emplace_back( mod_reg->import_from( l, db ) ) ;
+            }
+
+            for( size_t i=0; i<futures.size(); ++i )
+            {
+                natus::format::image_item_res_t ii = futures[i].get() ;
+                if( ii.is_valid() )
+                {
+                    imgs.append( *ii->img ) ;
+                }
+                if( trace != nullptr ) trace->end( phases[i], startup_trace_t::file_size( doc.sprite_sheets[i].image.src ) ) ;
+            }
+
+            return imgs ;
+        }
+
+        //********************************************************************************
+        static natus::gfx::sprite_sheet::sprite bake_sprite( natus::format::natus_document_t::sprite_sheet_t const & ss,
+            size_t const i, natus::math::vec2f_t const & dims ) noexcept
+        {
+            auto const & s = ss.sprites[i] ;
+
+            natus::math::vec4f_t const rect =
+                (natus::math::vec4f_t( s.animation.rect ) +
+                    natus::math::vec4f_t(0.0f,0.0f, 1.0f, 1.0f))/
+                natus::math::vec4f_t( dims, dims )  ;
+
+            natus::math::vec2f_t const pivot =
+                natus::math::vec2f_t( s.animation.pivot ) / dims ;
+
+            natus::gfx::sprite_sheet::sprite s_ ;
+            s_.rect = rect ;
+            s_.pivot = pivot ;
+
+            return s_ ;
+        }
+
+        //********************************************************************************
+        static natus::gfx::sprite_sheet::animation bake_animation( natus::format::natus_document_t::sprite_sheet_t const & ss,
+            size_t const i ) noexcept
+        {
+            auto const & a = ss.animations[i] ;
+
+            natus::gfx::sprite_sheet::animation a_ ;
+
+            size_t tp = 0 ;
+            for( auto const & f : a.frames )
+            {
+                auto iter = std::find_if( ss.sprites.begin(), ss.sprites.end(),
+                    [&]( natus::format::natus_document_t::sprite_sheet_t::sprite_cref_t s )
+                {
+                    return s.name == f.sprite ;
+                } ) ;
+                if( iter == ss.sprites.end() )
+                {
+                    natus::log::global_t::error("can not find sprite [" + f.sprite + "]" ) ;
+                    continue ;
+                }
+                size_t const d = std::distance( ss.sprites.begin(), iter ) ;
+                natus::gfx::sprite_sheet::animation::sprite s_ ;
+                s_.begin = tp ;
+                s_.end = tp + f.duration ;
+                s_.idx = d ;
+                a_.sprites.emplace_back( s_ ) ;
+
+                tp = s_.end ;
+            }
+            a_.duration = tp ;
+            a_.name = a.name ;
+
+            return a_ ;
+        }
+
+        //********************************************************************************
+        // calls funk( anim_idx, obj_id, ani_id ) in the order the animations are baked.
+        template< typename funk_t >
+        static void_t for_each_animation( natus::format::natus_document_t::sprite_sheet_t const & ss, funk_t funk ) noexcept
+        {
+            natus::ntd::map< natus::ntd::string_t, std::pair< size_t, size_t > > object_map ;
+
+            for( size_t i=0; i<ss.animations.size(); ++i )
+            {
+                auto const & a = ss.animations[i] ;
+
+                auto iter = object_map.find( a.object ) ;
+                if( iter == object_map.end() )
+                {
+                    iter = object_map.insert( std::make_pair( a.object,
+                        std::make_pair( object_map.size(), size_t( 0 ) ) ) ).first ;
+                }
+
+                funk( i, iter->second.first, iter->second.second++ ) ;
+            }
+        }
+
+        //********************************************************************************
+        static natus::gfx::sprite_sheet bake_sheet( natus::format::natus_document_t::sprite_sheet_t const & ss,
+            natus::math::vec2f_t const & dims ) noexcept
+        {
+            natus::gfx::sprite_sheet sheet ;
+
+            for( size_t i=0; i<ss.sprites.size(); ++i )
+            {
+                sheet.rects.emplace_back( this_t::bake_sprite( ss, i, dims ) ) ;
+            }
+
+            this_t::for_each_animation( ss, [&]( size_t const i, size_t const obj_id, size_t const )
+            {
+                if( obj_id == sheet.objects.size() )
+                {
+                    sheet.objects.emplace_back( natus::gfx::sprite_sheet::object { ss.animations[i].object, {} } ) ;
+                }
+                sheet.objects[obj_id].animations.emplace_back( this_t::bake_animation( ss, i ) ) ;
+            } ) ;
+
+            return sheet ;
+        }
+
+        //********************************************************************************
+        // re-bakes only the sprites and animations that differ between the two
+        // documents. If sprites or animations were added, removed or reordered
+        // the whole sheet is re-baked. Returns the number of re-baked items.
+        static size_t patch_sheet( natus::format::natus_document_t::sprite_sheet_t const & old_ss,
+            natus::format::natus_document_t::sprite_sheet_t const & ss, natus::math::vec2f_t const & dims,
+            natus::gfx::sprite_sheet & sheet ) noexcept
+        {
+            bool_t const same_sprites = old_ss.sprites.size() == ss.sprites.size() &&
+                std::equal( ss.sprites.begin(), ss.sprites.end(), old_ss.sprites.begin(),
+                    []( natus::format::natus_document_t::sprite_sheet_t::sprite_cref_t a,
+                        natus::format::natus_document_t::sprite_sheet_t::sprite_cref_t b )
+            {
+                return a.name == b.name ;
+            } ) ;
+
+            bool_t same_animations = old_ss.animations.size() == ss.animations.size() ;
+            for( size_t i=0; same_animations && i<ss.animations.size(); ++i )
+            {
+                same_animations = old_ss.animations[i].object == ss.animations[i].object &&
+                    old_ss.animations[i].name == ss.animations[i].name ;
+            }
+
+            if( !same_sprites || !same_animations )
+            {
+                sheet = this_t::bake_sheet( ss, dims ) ;
+                return ss.sprites.size() + ss.animations.size() ;
+            }
+
+            size_t num = 0 ;
+
+            for( size_t i=0; i<ss.sprites.size(); ++i )
+            {
+                auto const & a = old_ss.sprites[i].animation ;
+                auto const & b = ss.sprites[i].animation ;
+
+                bool_t const same =
+                    a.rect.x() == b.rect.x() && a.rect.y() == b.rect.y() &&
+                    a.rect.z() == b.rect.z() && a.rect.w() == b.rect.w() &&
+                    a.pivot.x() == b.pivot.x() && a.pivot.y() == b.pivot.y() ;
+
+                if( same ) continue ;
+
+                sheet.rects[i] = this_t::bake_sprite( ss, i, dims ) ;
+                ++num ;
+            }
+
+            this_t::for_each_animation( ss, [&]( size_t const i, size_t const obj_id, size_t const ani_id )
+            {
+                auto const & a = old_ss.animations[i].frames ;
+                auto const & b = ss.animations[i].frames ;
+
+                bool_t same = a.size() == b.size() ;
+                for( size_t f=0; same && f<a.size(); ++f )
+                {
+                    same = a[f].sprite == b[f].sprite && a[f].duration == b[f].duration ;
+                }
+
+                if( same ) return ;
+
+                sheet.objects[obj_id].animations[ani_id] = this_t::bake_animation( ss, i ) ;
+                ++num ;
+            } ) ;
+
+            return num ;
+        }
+
+        //********************************************************************************
+        // DATAPATH is set per game target
+        static void_t file_times( natus::format::natus_document_t const & doc,
+            std::filesystem::file_time_type & doc_time,
+            natus::ntd::vector< std::filesystem::file_time_type > & image_times ) noexcept
+        {
+            std::filesystem::path const base = std::filesystem::path( DATAPATH ) / "working" ;
+
+            std::error_code ec ;
+            doc_time = std::filesystem::last_write_time( base / "sprite_sheet.natus", ec ) ;
+
+            image_times.clear() ;
+            for( auto const & ss : doc.sprite_sheets )
+            {
+                image_times.emplace_back( std::filesystem::last_write_time( base / ss.image.src, ec ) ) ;
+            }
+        }
+    };
+    natus_typedef( sheet_reload ) ;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <natus/log/global.h>
+
+#include <atomic>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // lock-free single producer/single consumer ring with a fixed capacity.
+    // push fails if the ring is full so the producer never blocks or allocates.
+    template< typename T, size_t N >
+    class spsc_ring
+    {
+        natus_this_typedefs( spsc_ring ) ;
+
+        static_assert( N != 0 && (N & (N-1)) == 0, "capacity must be a power of two" ) ;
+
+    private:
+
+        T _items[N] ;
+
+        // written by the consumer
+        alignas( 64 ) std::atomic< size_t > _head { 0 } ;
+
+        // written by the producer
+        alignas( 64 ) std::atomic< size_t > _tail { 0 } ;
+
+    public:
+
+        spsc_ring( void_t ) noexcept {}
+        spsc_ring( this_cref_t ) = delete ;
+        spsc_ring( this_rref_t ) = delete ;
+
+    public:
+
+        bool_t push( T const & v ) noexcept
+        {
+            size_t const t = _tail.load( std::memory_order_relaxed ) ;
+            if( t - _head.load( std::memory_order_acquire ) == N ) return false ;
+
+            _items[ t & (N-1) ] = v ;
+            _tail.store( t + 1, std::memory_order_release ) ;
+
+            return true ;
+        }
+
+        // calls funk for every item pushed so far. Returns the number of items.
+        template< typename funk_t >
+        size_t drain( funk_t funk ) noexcept
+        {
+            size_t const h = _head.load( std::memory_order_relaxed ) ;
+            size_t const t = _tail.load( std::memory_order_acquire ) ;
+
+            for( size_t i=h; i!=t; ++i ) funk( _items[ i & (N-1) ] ) ;
+            _head.store( t, std::memory_order_release ) ;
+
+            return t - h ;
+        }
+    };
+}
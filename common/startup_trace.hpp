@@ -0,0 +1,167 @@
+#pragma once
+
+#include <natus/log/global.h>
+
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <cstdio>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // records begin and end of each startup phase relative to the trace
+    // start together with the bytes the phase read or produced. The report
+    // is written once the app sealed the trace and all phases are closed.
+    class startup_trace
+    {
+        natus_this_typedefs( startup_trace ) ;
+
+        typedef std::chrono::high_resolution_clock clock_t ;
+
+    private:
+
+        struct phase
+        {
+            natus::ntd::string_t name ;
+            size_t begin_us = 0 ;
+            size_t end_us = 0 ;
+            size_t bytes = 0 ;
+            bool_t ended = false ;
+        };
+
+        std::mutex _mtx ;
+        clock_t::time_point _start = clock_t::now() ;
+        natus::ntd::vector< phase > _phases ;
+        size_t _open = 0 ;
+        bool_t _sealed = false ;
+        bool_t _written = false ;
+
+        natus::ntd::string_t _game ;
+        natus::ntd::string_t _path ;
+
+    public:
+
+        startup_trace( natus::ntd::string_t const & game, natus::ntd::string_t const & path ) noexcept : 
+            _game( game ), _path( path ) {}
+
+    public:
+
+        // returns size_t(-1) if the report was already written
+        size_t begin( natus::ntd::string_t const & name ) noexcept
+        {
+            std::lock_guard< std::mutex > lk( _mtx ) ;
+            if( _written ) return size_t( -1 ) ;
+
+            phase p ;
+            p.name = name ;
+            p.begin_us = this_t::now_us() ;
+            _phases.emplace_back( std::move( p ) ) ;
+            ++_open ;
+
+            return _phases.size() - 1 ;
+        }
+
+        // an unknown id or a phase that already ended is ignored
+        void_t end( size_t const id, size_t const bytes = 0 ) noexcept
+        {
+            std::lock_guard< std::mutex > lk( _mtx ) ;
+            if( id >= _phases.size() || _phases[id].ended || _written ) return ;
+
+            _phases[id].end_us = this_t::now_us() ;
+            _phases[id].bytes = bytes ;
+            _phases[id].ended = true ;
+            --_open ;
+
+            this_t::write_if_done() ;
+        }
+
+        // the app will not begin any more phases of its own
+        void_t seal( void_t ) noexcept
+        {
+            std::lock_guard< std::mutex > lk( _mtx ) ;
+            _sealed = true ;
+            this_t::write_if_done() ;
+        }
+
+        // size of a file relative to the working directory of the game that
+        // includes this. DATAPATH is set per game target. 0 if not found.
+        static size_t file_size( natus::ntd::string_t const & rel ) noexcept
+        {
+            std::error_code ec ;
+            auto const sib = std::filesystem::file_size( 
+                std::filesystem::path( DATAPATH ) / "working" / rel, ec ) ;
+            return ec ? 0 : size_t( sib ) ;
+        }
+
+    private:
+
+        size_t now_us( void_t ) const noexcept
+        {
+            return size_t( std::chrono::duration_cast< std::chrono::microseconds >( 
+                clock_t::now() - _start ).count() ) ;
+        }
+
+        // names may carry asset paths
+        static natus::ntd::string_t escape( natus::ntd::string_t const & s ) noexcept
+        {
+            natus::ntd::string_t ret ;
+            ret.reserve( s.size() ) ;
+
+            for( char const c : s )
+            {
+                switch( c )
+                {
+                case '"': ret += "\\\"" ; break ;
+                case '\\': ret += "\\\\" ; break ;
+                case '\n': ret += "\\n" ; break ;
+                case '\r': ret += "\\r" ; break ;
+                case '\t': ret += "\\t" ; break ;
+                default:
+                    if( static_cast< unsigned char >( c ) < 0x20 )
+                    {
+                        char buf[8] ;
+                        std::snprintf( buf, sizeof( buf ), "\\u%04x", unsigned( c ) ) ;
+                        ret += buf ;
+                    }
+                    else ret += c ;
+                }
+            }
+            return ret ;
+        }
+
+        // requires the lock
+        void_t write_if_done( void_t ) noexcept
+        {
+            if( !_sealed || _open != 0 || _written ) return ;
+            _written = true ;
+
+            size_t const total = this_t::now_us() ;
+
+            std::ofstream out( _path, std::ios::trunc ) ;
+            out << "{\n  \"game\" : \"" << this_t::escape( _game ) << "\",\n  \"total_us\" : " << total << ",\n  \"phases\" : [\n" ;
+            for( size_t i=0; i<_phases.size(); ++i )
+            {
+                auto const & p = _phases[i] ;
+                out << "    { \"name\" : \"" << this_t::escape( p.name ) << "\", \"begin_us\" : " << p.begin_us << 
+                    ", \"end_us\" : " << p.end_us << ", \"duration_us\" : " << (p.end_us - p.begin_us) << 
+                    ", \"bytes\" : " << p.bytes << " }" << (i+1 < _phases.size() ? ",\n" : "\n") ;
+            }
+            out << "  ]\n}\n" ;
+
+            if( !out.good() )
+            {
+                natus::log::global_t::error( "[startup_trace] : can not write " + _path ) ;
+                return ;
+            }
+
+            natus::log::global_t::status( "[startup_trace] : " + std::to_string( _phases.size() ) + 
+                " phases in " + std::to_string( total ) + " us -> " + _path ) ;
+        }
+    };
+    natus_typedef( startup_trace ) ;
+    typedef std::shared_ptr< startup_trace_t > startup_trace_ptr_t ;
+}
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <natus/concurrent/global.h>
+#include <natus/log/global.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <initializer_list>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // a dependency graph of nodes that is built once and run every tick.
+    // Nodes without dependencies are ready right away, every other node 
+    // becomes ready when all nodes it depends on are done. 
+    //
+    // run() executes nodes on the caller and hands further ready nodes to
+    // helper tasks. The caller only waits while a helper is executing a node
+    // and never for a task that is still queued, so run() may be called from
+    // a task of the pool. Helpers exit when nothing is ready.
+    class tick_graph
+    {
+        natus_this_typedefs( tick_graph ) ;
+
+    public:
+
+        typedef std::function< void_t ( void_t ) > funk_t ;
+        typedef std::function< void_t ( size_t const, size_t const ) > range_funk_t ;
+        typedef std::function< size_t ( void_t ) > size_funk_t ;
+        typedef size_t node_t ;
+
+    private:
+
+        struct node
+        {
+            funk_t funk ;
+
+            // range nodes are split into chunks when they become ready
+            range_funk_t range ;
+            size_funk_t size ;
+            size_t grain = 1 ;
+            size_t max_tasks = 0 ;
+
+            natus::ntd::vector< node_t > next ;
+            size_t num_deps = 0 ;
+        };
+
+        struct item
+        {
+            node_t node ;
+            size_t b ;
+            size_t e ;
+        };
+
+        // shared with the helper tasks so a late helper never outlives it
+        struct core
+        {
+            natus::ntd::vector< node > nodes ;
+
+            std::mutex mtx ;
+            std::condition_variable cv ;
+
+            // per run. guarded by mtx.
+            natus::ntd::vector< item > ready ;
+            natus::ntd::vector< size_t > deps_left ;
+            natus::ntd::vector< size_t > chunks_left ;
+            size_t nodes_left = 0 ;
+            size_t helpers = 0 ;
+            size_t max_helpers = 0 ;
+        };
+        typedef std::shared_ptr< core > core_ptr_t ;
+        typedef core & core_ref_t ;
+
+        core_ptr_t _core = std::make_shared< core >() ;
+
+    public:
+
+        tick_graph( void_t ) noexcept
+        {
+            size_t const hw = std::max( size_t( std::thread::hardware_concurrency() ), size_t( 1 ) ) ;
+            _core->max_helpers = hw - 1 ;
+        }
+        tick_graph( this_cref_t ) = delete ;
+        tick_graph( this_rref_t ) = delete ;
+
+    public:
+
+        bool_t empty( void_t ) const noexcept { return _core->nodes.empty() ; }
+
+        node_t add( funk_t funk, std::initializer_list< node_t > const deps = {} ) noexcept
+        {
+            node n ;
+            n.funk = std::move( funk ) ;
+            return this_t::connect( std::move( n ), deps ) ;
+        }
+
+        // adds a node calling funk( begin, end ) over chunks of [0,size()) of 
+        // at least grain elements. size is taken when the node becomes ready.
+        // max_tasks caps the chunks, 0 means one chunk per hardware thread.
+        node_t add_for( size_funk_t size, size_t const grain, range_funk_t funk, 
+            std::initializer_list< node_t > const deps = {}, size_t const max_tasks = 0 ) noexcept
+        {
+            node n ;
+            n.range = std::move( funk ) ;
+            n.size = std::move( size ) ;
+            n.grain = std::max( grain, size_t( 1 ) ) ;
+            n.max_tasks = max_tasks ;
+            return this_t::connect( std::move( n ), deps ) ;
+        }
+
+        // runs the whole graph and returns when all nodes are done
+        void_t run( void_t ) noexcept
+        {
+            core_ref_t c = *_core ;
+            if( c.nodes.empty() ) return ;
+
+            size_t spawn = 0 ;
+            {
+                std::lock_guard< std::mutex > lk( c.mtx ) ;
+
+                c.ready.clear() ;
+                c.nodes_left = c.nodes.size() ;
+                c.deps_left.resize( c.nodes.size() ) ;
+                c.chunks_left.resize( c.nodes.size() ) ;
+                for( size_t i=0; i<c.nodes.size(); ++i ) c.deps_left[i] = c.nodes[i].num_deps ;
+
+                for( size_t i=0; i<c.nodes.size(); ++i ) 
+                {
+                    if( c.nodes[i].num_deps == 0 ) this_t::make_ready( c, i ) ;
+                }
+                spawn = this_t::num_to_spawn( c ) ;
+            }
+            this_t::spawn( _core, spawn ) ;
+
+            std::unique_lock< std::mutex > lk( c.mtx ) ;
+            while( c.nodes_left != 0 )
+            {
+                if( c.ready.empty() ) 
+                {
+                    // only nodes running on helpers are left
+                    c.cv.wait( lk ) ;
+                    continue ;
+                }
+                this_t::execute_one( _core, lk ) ;
+            }
+        }
+
+    private:
+
+        node_t connect( node && n, std::initializer_list< node_t > const deps ) noexcept
+        {
+            auto & nodes = _core->nodes ;
+
+            n.num_deps = deps.size() ;
+            nodes.emplace_back( std::move( n ) ) ;
+
+            node_t const id = nodes.size() - 1 ;
+            for( auto const d : deps ) nodes[d].next.emplace_back( id ) ;
+
+            return id ;
+        }
+
+        // requires the lock
+        static void_t make_ready( core_ref_t c, node_t const i ) noexcept
+        {
+            auto const & n = c.nodes[i] ;
+
+            if( !n.range )
+            {
+                c.chunks_left[i] = 1 ;
+                c.ready.emplace_back( item { i, 0, 0 } ) ;
+                return ;
+            }
+
+            size_t const num = n.size() ;
+            if( num == 0 ) 
+            {
+                this_t::finish( c, i ) ;
+                return ;
+            }
+
+            size_t const hw = c.max_helpers + 1 ;
+            size_t const tasks = std::max( std::min( n.max_tasks == 0 ? hw : n.max_tasks, num / n.grain ), size_t( 1 ) ) ;
+            size_t const chunk = (num + tasks - 1) / tasks ;
+
+            c.chunks_left[i] = (num + chunk - 1) / chunk ;
+            for( size_t b=0; b<num; b+=chunk )
+            {
+                c.ready.emplace_back( item { i, b, std::min( b + chunk, num ) } ) ;
+            }
+        }
+
+        // requires the lock
+        static void_t finish( core_ref_t c, node_t const i ) noexcept
+        {
+            --c.nodes_left ;
+            for( auto const n : c.nodes[i].next )
+            {
+                if( --c.deps_left[n] == 0 ) this_t::make_ready( c, n ) ;
+            }
+            c.cv.notify_all() ;
+        }
+
+        // requires the lock. The executing thread picks one item itself.
+        static size_t num_to_spawn( core_ref_t c ) noexcept
+        {
+            size_t const want = c.ready.size() > 1 ? c.ready.size() - 1 : 0 ;
+            size_t const n = std::min( want, c.max_helpers - c.helpers ) ;
+            c.helpers += n ;
+            return n ;
+        }
+
+        // takes one ready item, runs it without the lock and finishes it
+        static void_t execute_one( core_ptr_t const & cp, std::unique_lock< std::mutex > & lk ) noexcept
+        {
+            core_ref_t c = *cp ;
+
+            item const it = c.ready.back() ;
+            c.ready.pop_back() ;
+
+            lk.unlock() ;
+            {
+                auto const & n = c.nodes[ it.node ] ;
+                if( n.range ) n.range( it.b, it.e ) ;
+                else n.funk() ;
+            }
+            lk.lock() ;
+
+            if( --c.chunks_left[ it.node ] == 0 ) this_t::finish( c, it.node ) ;
+
+            size_t const spawn = this_t::num_to_spawn( c ) ;
+            if( spawn != 0 )
+            {
+                lk.unlock() ;
+                this_t::spawn( cp, spawn ) ;
+                lk.lock() ;
+            }
+        }
+
+        static void_t spawn( core_ptr_t const & cp, size_t const num ) noexcept
+        {
+            if( num == 0 ) return ;
+
+            natus::concurrent::task_res_t root = natus::concurrent::task_t( []( natus::concurrent::task_res_t ){} ) ;
+            for( size_t i=0; i<num; ++i )
+            {
+                natus::concurrent::task_res_t t = natus::concurrent::task_t( [cp]( natus::concurrent::task_res_t )
+                {
+                    std::unique_lock< std::mutex > lk( cp->mtx ) ;
+                    while( !cp->ready.empty() ) this_t::execute_one( cp, lk ) ;
+                    --cp->helpers ;
+                } ) ;
+                root->then( t ) ;
+            }
+            natus::concurrent::global_t::schedule( root, natus::concurrent::schedule_type::loose ) ;
+        }
+    };
+    natus_typedef( tick_graph ) ;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <natus/log/global.h>
+
+#include <atomic>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // lock-free single producer/single consumer triple buffer. The producer 
+    // owns one slot, the consumer owns one slot and the third slot is the 
+    // latest published one. Publishing and reading swap the own slot with the
+    // published slot so neither side ever waits on the other.
+    template< typename T >
+    class triple_buffer
+    {
+        natus_this_typedefs( triple_buffer< T > ) ;
+
+    private:
+
+        // bits 0-1 : index of the published slot
+        // bit 2 : the published slot was not read yet
+        static uint8_t const fresh_bit = 4 ;
+
+        T _slots[3] ;
+        std::atomic< uint8_t > _middle { 1 } ;
+
+        // only touched by the producer
+        uint8_t _write = 0 ;
+
+        // only touched by the consumer
+        uint8_t _read = 2 ;
+
+    public:
+
+        triple_buffer( void_t ) noexcept {}
+        triple_buffer( this_cref_t ) = delete ;
+        triple_buffer( this_rref_t ) = delete ;
+
+    public: // producer
+
+        // the slot to fill. It holds the data of an older publish.
+        T & write_slot( void_t ) noexcept { return _slots[_write] ; }
+
+        void_t publish( void_t ) noexcept
+        {
+            _write = _middle.exchange( uint8_t( _write | fresh_bit ), std::memory_order_acq_rel ) & 3 ;
+        }
+
+    public: // consumer
+
+        // takes the latest published slot if there is a new one. The 
+        // returned slot stays valid until the next call.
+        T const & read( void_t ) noexcept
+        {
+            if( _middle.load( std::memory_order_acquire ) & fresh_bit )
+            {
+                _read = _middle.exchange( _read, std::memory_order_acq_rel ) & 3 ;
+            }
+            return _slots[_read] ;
+        }
+    };
+}
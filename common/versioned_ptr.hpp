@@ -0,0 +1,67 @@
+#pragma once
+
+#include <natus/log/global.h>
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+namespace games
+{
+    using namespace natus::core::types ;
+
+    // the current version of some data that is built off the callbacks. 
+    // Readers load the pointer once per call and keep using that object 
+    // until the next call. Every build gets a version when it is started
+    // and a build is only published if nothing newer was published already.
+    // A published object is never changed. A change is a new version.
+    template< typename T >
+    class versioned_ptr
+    {
+        natus_this_typedefs( versioned_ptr ) ;
+
+    public:
+
+        typedef std::shared_ptr< T > ptr_t ;
+
+    private:
+
+        // guards _ptr. Only held for the copy of the pointer.
+        mutable std::mutex _mtx ;
+        ptr_t _ptr ;
+
+        std::atomic< size_t > _issued { 0 } ;
+        std::atomic< size_t > _published { 0 } ;
+
+    public:
+
+        versioned_ptr( void_t ) noexcept {}
+        versioned_ptr( this_cref_t ) = delete ;
+        versioned_ptr( this_rref_t ) = delete ;
+
+    public:
+
+        // the version for a build that is about to start
+        size_t issue( void_t ) noexcept { return ++_issued ; }
+
+        size_t version( void_t ) const noexcept { return _published ; }
+
+        ptr_t load( void_t ) const noexcept 
+        { 
+            std::lock_guard< std::mutex > lk( _mtx ) ;
+            return _ptr ; 
+        }
+
+        // returns false if p was superseded by a newer version
+        bool_t publish( ptr_t p, size_t const v ) noexcept
+        {
+            std::lock_guard< std::mutex > lk( _mtx ) ;
+            if( v < _published ) return false ;
+
+            _ptr.swap( p ) ;
+            _published = v ;
+
+            return true ;
+        }
+    };
+}